@@ -0,0 +1,286 @@
+// Solves a file of instances with libmultiset (see library/multiset.h), remembering the results in a store.
+//
+// Usage: batch [-b | --branch-and-bound] [--bound=NAME] [--cache=MB] [--threads=T] [--store=FILE] [FILE]
+//
+// The input (FILE, or standard input) is any number of instances "d n m a_1 ... a_n b_1 ... b_m", the task input
+// without t, separated by any whitespace. The solution of each one is printed in the order given, as the solvers
+// print it (see solution_print).
+//
+// Instances found in the store at FILE (see store.h) are answered from it. The others are estimated (see
+// multiset_estimate) and solved on a pool of T threads (all cores by default), from the largest estimate down,
+// so that the longest ones don't start last. Each gets one thread, or an even share of them if there are fewer
+// instances than threads. Repeated instances are solved once, and every solution goes to the store as soon as
+// it's found. A summary is printed to stderr:
+//   batch: instances=N stored=S solved=K repeated=R estimate_s=0.012 run_s=1.234
+#include "batch/store.h"
+#include "common/err.h"
+#include "common/stats.h"
+#include "library/multiset.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_ESTIMATE_PROBES 1000
+// How long to sleep when no running instance is done: from the minimum, doubled after each sleep in a row,
+// so that short instances aren't held up and long ones aren't polled for nothing.
+#define BATCH_POLL_MIN_NS 10000
+#define BATCH_POLL_MAX_NS 1000000
+
+enum {
+    OPTION_BOUND = 256,
+    OPTION_CACHE,
+    OPTION_THREADS,
+    OPTION_STORE,
+};
+
+typedef struct Instance {
+    int d, n, m;
+    int* a;
+    int* b;
+    StoreKey key;
+    double estimate;
+    const struct Instance* same_as; // an earlier instance in the schedule with the same key, or NULL
+    MultisetSolution solution;
+} Instance;
+
+// An instance being solved on the pool.
+typedef struct Running {
+    Instance* instance;
+    MultisetJob* job;
+} Running;
+
+static _Noreturn void usage(const char* program)
+{
+    fatal("usage: %s [-b | --branch-and-bound] [--bound=NAME] [--cache=MB] [--threads=T] [--store=FILE] [FILE]",
+        program);
+}
+
+// Parse a positive decimal number (on bad usage, print a usage message and quit).
+static unsigned long parse_positive(const char* program, const char* arg)
+{
+    char* end;
+    unsigned long number = strtoul(arg, &end, 10);
+    if (*arg == '\0' || *arg == '-' || *end != '\0' || number == 0)
+        usage(program);
+    return number;
+}
+
+static int* read_elements(FILE* file, const char* name, int index, int count, int d)
+{
+    int* elements = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (elements == NULL)
+        fatal("cannot allocate %d elements", count);
+    for (int i = 0; i < count; i++) {
+        if (fscanf(file, "%d", &elements[i]) != 1)
+            fatal("%s: instance %d is truncated", name, index + 1);
+        if (elements[i] < 1 || elements[i] > d)
+            fatal("%s: instance %d: element %d is not in [1, %d]", name, index + 1, elements[i], d);
+    }
+    return elements;
+}
+
+static Instance* read_instances(FILE* file, const char* name, int* count)
+{
+    int size = 16;
+    Instance* instances = malloc(size * sizeof(Instance));
+    *count = 0;
+    int d, n, m;
+    int read;
+    while ((read = fscanf(file, "%d%d%d", &d, &n, &m)) == 3) {
+        if (d < 3 || d > MULTISET_MAX_D)
+            fatal("%s: instance %d: d=%d is not supported, it must be in [3, %d]", name, *count + 1, d,
+                MULTISET_MAX_D);
+        if (n < 0 || m < 0)
+            fatal("%s: instance %d: negative multiset size", name, *count + 1);
+        if (*count == size) {
+            size *= 2;
+            instances = realloc(instances, size * sizeof(Instance));
+        }
+        if (instances == NULL)
+            fatal("cannot allocate %d instances", size);
+        Instance* instance = &instances[(*count)++];
+        instance->d = d;
+        instance->n = n;
+        instance->m = m;
+        instance->a = read_elements(file, name, *count - 1, n, d);
+        instance->b = read_elements(file, name, *count - 1, m, d);
+        store_key_init(&instance->key, d, instance->a, n, instance->b, m);
+        instance->same_as = NULL;
+    }
+    if (read != EOF)
+        fatal("%s: malformed instance %d", name, *count + 1);
+    return instances;
+}
+
+// Largest estimate first. Equal instances have equal estimates (they're reproducible), so ordering ties by key
+// puts repeated instances next to each other.
+static int compare_estimates(const void* x, const void* y)
+{
+    const Instance* a = *(Instance* const*)x;
+    const Instance* b = *(Instance* const*)y;
+    if (a->estimate != b->estimate)
+        return a->estimate > b->estimate ? -1 : 1;
+    return memcmp(&a->key, &b->key, sizeof(StoreKey));
+}
+
+static void print_multiset(const int count[MULTISET_MAX_D + 1])
+{
+    bool first = true;
+    for (int i = 0; i <= MULTISET_MAX_D; i++) {
+        if (count[i]) {
+            if (first)
+                first = false;
+            else
+                printf(" ");
+            if (count[i] > 1)
+                printf("%dx", count[i]);
+            printf("%d", i);
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+    static const struct option long_options[] = {
+        { "branch-and-bound", no_argument, NULL, 'b' },
+        { "bound", required_argument, NULL, OPTION_BOUND },
+        { "cache", required_argument, NULL, OPTION_CACHE },
+        { "threads", required_argument, NULL, OPTION_THREADS },
+        { "store", required_argument, NULL, OPTION_STORE },
+        { NULL, 0, NULL, 0 },
+    };
+    MultisetOptions options;
+    multiset_options_init(&options);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = cores > 0 ? cores : 1;
+    const char* store_path = NULL;
+    int c;
+    while ((c = getopt_long(argc, argv, "b", long_options, NULL)) != -1) {
+        switch (c) {
+        case 'b':
+            options.bound = "pigeonhole";
+            break;
+        case OPTION_BOUND:
+            options.bound = optarg;
+            break;
+        case OPTION_CACHE:
+            options.cache_bytes = parse_positive(argv[0], optarg) << 20;
+            break;
+        case OPTION_THREADS:
+            threads = parse_positive(argv[0], optarg);
+            break;
+        case OPTION_STORE:
+            store_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind < argc - 1 || multiset_estimate(3, NULL, 0, NULL, 0, &options, 0) < 0)
+        usage(argv[0]);
+
+    const char* name = optind < argc ? argv[optind] : "stdin";
+    FILE* file = optind < argc ? fopen(name, "r") : stdin;
+    if (file == NULL)
+        syserr("cannot open %s", name);
+    int count;
+    Instance* instances = read_instances(file, name, &count);
+    if (file != stdin)
+        fclose(file);
+
+    uint64_t start_ns = stats_now_ns();
+    Store store;
+    if (store_path != NULL)
+        store_open(&store, store_path);
+
+    // Instances to solve, from the largest estimate down.
+    Instance** schedule = malloc((count > 0 ? count : 1) * sizeof(Instance*));
+    if (schedule == NULL)
+        fatal("cannot allocate %d instances", count);
+    int scheduled = 0;
+    int stored = 0;
+    for (int i = 0; i < count; i++) {
+        if (store_path != NULL && store_find(&store, &instances[i].key, &instances[i].solution))
+            stored++;
+        else
+            schedule[scheduled++] = &instances[i];
+    }
+    for (int i = 0; i < scheduled; i++) {
+        Instance* instance = schedule[i];
+        instance->estimate = multiset_estimate(instance->d, instance->a, instance->n, instance->b, instance->m,
+            &options, BATCH_ESTIMATE_PROBES);
+        // The options were checked above, and the elements by read_instances.
+        if (instance->estimate < 0)
+            fatal("instance d=%d n=%d m=%d: the sums of A_0 and B_0 must be below %d", instance->d, instance->n,
+                instance->m, MULTISET_MAX_D * MULTISET_MAX_D);
+    }
+    qsort(schedule, scheduled, sizeof(Instance*), compare_estimates);
+    int unique = 0;
+    for (int i = 0; i < scheduled; i++) {
+        if (unique > 0 && memcmp(&schedule[i]->key, &schedule[unique - 1]->key, sizeof(StoreKey)) == 0)
+            schedule[i]->same_as = schedule[unique - 1];
+        else
+            schedule[unique++] = schedule[i];
+    }
+    uint64_t estimate_ns = stats_now_ns() - start_ns;
+
+    MultisetPool* pool = multiset_pool_create(threads);
+    options.threads = unique > 0 && threads / unique > 1 ? threads / unique : 1;
+    Running running[threads];
+    int running_count = 0;
+    int next = 0;
+    long poll_ns = BATCH_POLL_MIN_NS;
+    while (next < unique || running_count > 0) {
+        while (next < unique && (running_count + 1) * options.threads <= threads) {
+            Instance* instance = schedule[next++];
+            running[running_count].instance = instance;
+            running[running_count].job = multiset_submit(pool, instance->d, instance->a, instance->n, instance->b,
+                instance->m, &options);
+            running_count++;
+        }
+
+        bool any_done = false;
+        for (int i = 0; i < running_count; i++) {
+            Instance* instance = running[i].instance;
+            if (multiset_poll(running[i].job, &instance->solution)) {
+                if (store_path != NULL)
+                    store_put(&store, &instance->key, &instance->solution);
+                running[i--] = running[--running_count];
+                any_done = true;
+            }
+        }
+        if (any_done) {
+            poll_ns = BATCH_POLL_MIN_NS;
+        } else {
+            nanosleep(&(struct timespec) { .tv_sec = 0, .tv_nsec = poll_ns }, NULL);
+            poll_ns = poll_ns * 2 < BATCH_POLL_MAX_NS ? poll_ns * 2 : BATCH_POLL_MAX_NS;
+        }
+    }
+    multiset_pool_destroy(pool);
+    if (store_path != NULL)
+        store_close(&store);
+
+    for (int i = 0; i < count; i++) {
+        const Instance* instance = &instances[i];
+        const MultisetSolution* solution = instance->same_as ? &instance->same_as->solution : &instance->solution;
+        printf("%d\n", solution->sum);
+        print_multiset(solution->a);
+        print_multiset(solution->b);
+    }
+    fprintf(stderr, "batch: instances=%d stored=%d solved=%d repeated=%d estimate_s=%.3f run_s=%.3f\n", count,
+        stored, unique, scheduled - unique, estimate_ns / 1e9, (stats_now_ns() - start_ns) / 1e9);
+
+    for (int i = 0; i < count; i++) {
+        free(instances[i].a);
+        free(instances[i].b);
+    }
+    free(instances);
+    free(schedule);
+    return 0;
+}
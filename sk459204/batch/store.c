@@ -0,0 +1,183 @@
+#include "batch/store.h"
+#include "common/err.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define STORE_MAGIC "MSSTORE1"
+#define STORE_INITIAL_CAPACITY 1024 // records, always a power of two
+
+typedef struct StoreHeader {
+    char magic[8];
+    uint64_t capacity;
+    uint64_t count;
+    uint64_t reserved[5]; // keeps the records 64-byte aligned
+} StoreHeader;
+
+static size_t store_size(uint64_t capacity)
+{
+    return sizeof(StoreHeader) + capacity * sizeof(StoreRecord);
+}
+
+// FNV-1a of the whole key (it has no padding, and store_key_init clears all counts).
+static uint64_t key_hash(const StoreKey* key)
+{
+    const unsigned char* bytes = (const unsigned char*)key;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < sizeof(StoreKey); i++)
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    return hash != 0 ? hash : 1;
+}
+
+void store_key_init(StoreKey* key, int d, const int* a0, int n, const int* b0, int m)
+{
+    memset(key, 0, sizeof(StoreKey));
+    key->d = d;
+    for (int i = 0; i < n; i++)
+        key->a0[a0[i]]++;
+    for (int i = 0; i < m; i++)
+        key->b0[b0[i]]++;
+}
+
+// Slot of the record with the key, or of the empty slot where it would go.
+static StoreRecord* slot(StoreRecord* records, uint64_t capacity, const StoreKey* key, uint64_t hash)
+{
+    uint64_t i = hash & (capacity - 1);
+    while (records[i].hash != 0 && (records[i].hash != hash || memcmp(&records[i].key, key, sizeof(StoreKey)) != 0))
+        i = (i + 1) & (capacity - 1);
+    return &records[i];
+}
+
+// Map the file open at fd, of the given size.
+static StoreHeader* map(const char* path, int fd, size_t size)
+{
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+        syserr("cannot map the store %s", path);
+    return mapping;
+}
+
+// Set the file open at fd to an empty store of the given capacity, and map it into `store`.
+static void create(Store* store, const char* path, int fd, uint64_t capacity)
+{
+    ASSERT_SYS_OK(ftruncate(fd, 0));
+    ASSERT_SYS_OK(ftruncate(fd, store_size(capacity)));
+    store->fd = fd;
+    store->size = store_size(capacity);
+    store->header = map(path, fd, store->size);
+    memcpy(store->header->magic, STORE_MAGIC, sizeof(store->header->magic));
+    store->header->capacity = capacity;
+    store->header->count = 0;
+    store->records = (StoreRecord*)(store->header + 1);
+}
+
+void store_open(Store* store, const char* path)
+{
+    store->path = path;
+    int fd;
+    while (true) {
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+            syserr("cannot open the store %s", path);
+        ASSERT_SYS_OK(flock(fd, LOCK_EX));
+        // Another batch may have replaced the file (see store_put) while this one waited for the lock.
+        struct stat locked, current;
+        ASSERT_SYS_OK(fstat(fd, &locked));
+        if (stat(path, &current) == 0 && current.st_dev == locked.st_dev && current.st_ino == locked.st_ino)
+            break;
+        ASSERT_SYS_OK(close(fd));
+    }
+
+    struct stat file;
+    ASSERT_SYS_OK(fstat(fd, &file));
+    if (file.st_size == 0) {
+        create(store, path, fd, STORE_INITIAL_CAPACITY);
+        return;
+    }
+    if ((size_t)file.st_size < sizeof(StoreHeader))
+        fatal("%s is not a result store", path);
+    store->fd = fd;
+    store->size = file.st_size;
+    store->header = map(path, fd, store->size);
+    store->records = (StoreRecord*)(store->header + 1);
+    uint64_t capacity = store->header->capacity;
+    if (memcmp(store->header->magic, STORE_MAGIC, sizeof(store->header->magic)) != 0 || capacity == 0
+        || (capacity & (capacity - 1)) != 0 || store_size(capacity) != store->size)
+        fatal("%s is not a result store", path);
+}
+
+bool store_find(const Store* store, const StoreKey* key, MultisetSolution* solution)
+{
+    const StoreRecord* record = slot(store->records, store->header->capacity, key, key_hash(key));
+    if (record->hash == 0)
+        return false;
+    solution->sum = record->sum;
+    for (int i = 0; i <= MULTISET_MAX_D; i++) {
+        solution->a[i] = record->a[i];
+        solution->b[i] = record->b[i];
+    }
+    solution->nodes = record->nodes;
+    solution->pruned = record->pruned;
+    return true;
+}
+
+// Rebuild the store twice as large into path.tmp and rename it over path. The new file is locked before it's
+// renamed, so batches waiting for the lock find it.
+static void grow(Store* store)
+{
+    char tmp_path[strlen(store->path) + 5];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", store->path);
+    int fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        syserr("cannot create %s", tmp_path);
+    ASSERT_SYS_OK(flock(fd, LOCK_EX));
+
+    Store grown;
+    grown.path = store->path;
+    create(&grown, tmp_path, fd, 2 * store->header->capacity);
+    for (uint64_t i = 0; i < store->header->capacity; i++) {
+        const StoreRecord* record = &store->records[i];
+        if (record->hash != 0)
+            *slot(grown.records, grown.header->capacity, &record->key, record->hash) = *record;
+    }
+    grown.header->count = store->header->count;
+    ASSERT_SYS_OK(msync(grown.header, grown.size, MS_SYNC));
+    ASSERT_SYS_OK(rename(tmp_path, store->path));
+
+    store_close(store);
+    *store = grown;
+}
+
+void store_put(Store* store, const StoreKey* key, const MultisetSolution* solution)
+{
+    if (4 * (store->header->count + 1) > 3 * store->header->capacity)
+        grow(store);
+
+    uint64_t hash = key_hash(key);
+    StoreRecord* record = slot(store->records, store->header->capacity, key, hash);
+    bool added = record->hash == 0;
+    record->key = *key;
+    record->sum = solution->sum;
+    for (int i = 0; i <= MULTISET_MAX_D; i++) {
+        record->a[i] = solution->a[i];
+        record->b[i] = solution->b[i];
+    }
+    record->nodes = solution->nodes;
+    record->pruned = solution->pruned;
+    // Last, so that a record is only found once it's complete.
+    record->hash = hash;
+    if (added)
+        store->header->count++;
+}
+
+void store_close(Store* store)
+{
+    ASSERT_SYS_OK(munmap(store->header, store->size));
+    ASSERT_SYS_OK(close(store->fd));
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "library/multiset.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A file of solved instances, memory-mapped so that looking one up costs a hash and a few comparisons: an
+// open-addressing hash table of fixed-size records, keyed on the canonical instance (d, and A₀ and B₀ as counts
+// of each element, which is the same as sorted), each with α and a witness pair. Records are written in place,
+// so they survive the process being killed. When the table gets 3/4 full, it's rebuilt twice as large into
+// FILE.tmp, which is renamed over FILE.
+//
+// A batch holds an exclusive lock on the file while it runs, so that batches sharing a store run one at a time.
+// The file is in the byte order of the machine.
+
+typedef struct StoreKey {
+    int32_t d;
+    int32_t a0[MULTISET_MAX_D + 1]; // a0[i] is the number of i in A₀
+    int32_t b0[MULTISET_MAX_D + 1];
+} StoreKey;
+
+typedef struct StoreRecord {
+    uint64_t hash; // of the key, 0 for an empty slot
+    StoreKey key;
+    int32_t sum;
+    int32_t a[MULTISET_MAX_D + 1]; // the witness, as in MultisetSolution
+    int32_t b[MULTISET_MAX_D + 1];
+    uint64_t nodes; // nodes expanded to solve it
+    uint64_t pruned;
+} StoreRecord;
+
+struct StoreHeader;
+
+typedef struct Store {
+    const char* path;
+    int fd;
+    struct StoreHeader* header; // the mapping of the whole file
+    size_t size;
+    StoreRecord* records;
+} Store;
+
+// Canonical key of the instance (elements must be in [1, d]).
+void store_key_init(StoreKey* key, int d, const int* a0, int n, const int* b0, int m);
+
+// Open the store at `path`, creating an empty one if there's none, and lock it (waiting for other batches).
+// Quits if it can't, or if the file isn't a store.
+void store_open(Store* store, const char* path);
+
+// If the instance was solved, fill `solution` with what was recorded and return true.
+bool store_find(const Store* store, const StoreKey* key, MultisetSolution* solution);
+
+// Record the solution of the instance (replacing an earlier one).
+void store_put(Store* store, const StoreKey* key, const MultisetSolution* solution);
+
+// Unmap and unlock the store.
+void store_close(Store* store);
@@ -0,0 +1,206 @@
+// Microbenchmarks of the sumset operations the search spends its time in, for every kernel variant the CPU
+// supports (see SumsetKernels in common/sumset.h).
+//
+// Usage: bench_kernels [--json=FILE]
+//
+// Prints one CSV row per measurement (and writes the same rows to FILE as JSON, see report.h):
+//   benchmark,kernels,sum,words,x,depth,ns_per_op
+// - sumset_add: A^Σ with ∑A = sum, shifted by x, over `words` live words of the result;
+// - is_sumset_intersection_trivial, get_sumset_intersection_size: two sumsets with ∑ = sum that only share 0,
+//   so that every live word is read;
+// - solution_build: A and B with `depth` elements each, so that ∑A = sum.
+// Fields that don't apply are 0, and `kernels` is "none" for solution_build. Sumsets shorter than
+// SUMSET_KERNELS_MIN_WORDS use the inlined scalar loops whatever the variant, which shows where the kernels take over.
+#include "bench/report.h"
+#include "common/err.h"
+#include "common/io.h"
+#include "common/stats.h"
+#include "common/sumset.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+// Every measurement is a batch of calls taking at least this long (doubled until it does).
+#define BENCH_MIN_NS 20000000
+
+// Keeps the compiler from dropping or merging calls whose results aren't used.
+#define BENCH_BARRIER() __asm__ volatile("" ::: "memory")
+
+typedef void (*BenchBody)(void* state, long iterations);
+
+// Nanoseconds per call of body, from the first batch that takes at least BENCH_MIN_NS.
+static double measure(BenchBody body, void* state)
+{
+    for (long iterations = 1;; iterations *= 2) {
+        uint64_t start_ns = stats_now_ns();
+        body(state, iterations);
+        uint64_t elapsed_ns = stats_now_ns() - start_ns;
+        if (elapsed_ns >= BENCH_MIN_NS)
+            return (double)elapsed_ns / iterations;
+    }
+}
+
+typedef struct Pair {
+    Sumset a, b, result;
+    int x;
+    InputData input;
+    const Sumset* top_a; // ends of the chains for solution_build
+    const Sumset* top_b;
+} Pair;
+
+static Pair pair;
+static Sumset chain_a[MAX_D + 1], chain_b[MAX_D + 1];
+
+static void add_body(void* state, long iterations)
+{
+    Pair* p = state;
+    for (long i = 0; i < iterations; i++) {
+        sumset_add(&p->result, &p->a, p->x);
+        BENCH_BARRIER();
+    }
+}
+
+static void trivial_body(void* state, long iterations)
+{
+    Pair* p = state;
+    for (long i = 0; i < iterations; i++) {
+        if (!is_sumset_intersection_trivial(&p->a, &p->b))
+            fatal("is_sumset_intersection_trivial: the benchmark sumsets intersect");
+        BENCH_BARRIER();
+    }
+}
+
+static void size_body(void* state, long iterations)
+{
+    Pair* p = state;
+    for (long i = 0; i < iterations; i++) {
+        if (get_sumset_intersection_size(&p->a, &p->b) != 1)
+            fatal("get_sumset_intersection_size: the benchmark sumsets intersect");
+        BENCH_BARRIER();
+    }
+}
+
+static void build_body(void* state, long iterations)
+{
+    Pair* p = state;
+    Solution solution;
+    for (long i = 0; i < iterations; i++) {
+        solution_build(&solution, &p->input, p->top_a, p->top_b);
+        BENCH_BARRIER();
+    }
+}
+
+// Set s to A^Σ of some A with ∑A = sum, adding the largest elements first.
+static void make_sumset(Sumset* s, int sum)
+{
+    sumset_init(s);
+    while (s->sum < sum) {
+        int x = sum - s->sum < MAX_D ? sum - s->sum : MAX_D;
+        _sumset_add(s, s, x);
+    }
+}
+
+// Set s to a sumset with the given sum whose live words all have the bits of `pattern` (and 0, and nothing
+// above sum). It doesn't come from any multiset, but the kernels only see words.
+static void make_pattern(Sumset* s, int sum, Word pattern)
+{
+    sumset_init(s);
+    s->sum = sum;
+    int words = sumset_live_words(sum);
+    for (int i = 0; i < words; i++)
+        s->sumset[i] = pattern;
+    s->sumset[0] |= 1;
+    int high = sum % BITS_PER_WORD;
+    if (high < (int)BITS_PER_WORD - 1)
+        s->sumset[words - 1] &= (((Word)1) << (high + 1)) - 1;
+}
+
+static void report_measurement(Report* report, const char* benchmark, const char* kernels, int sum, int words, int x,
+    int depth, double ns_per_op)
+{
+    char sum_text[16], words_text[16], x_text[16], depth_text[16], ns_text[32];
+    snprintf(sum_text, sizeof(sum_text), "%d", sum);
+    snprintf(words_text, sizeof(words_text), "%d", words);
+    snprintf(x_text, sizeof(x_text), "%d", x);
+    snprintf(depth_text, sizeof(depth_text), "%d", depth);
+    snprintf(ns_text, sizeof(ns_text), "%.2f", ns_per_op);
+    const char* values[] = { benchmark, kernels, sum_text, words_text, x_text, depth_text, ns_text };
+    report_row(report, values);
+}
+
+static void bench_kernels(Report* report)
+{
+    static const int sums[] = { 100, 1000, 4000, 16000 };
+    static const int shifts[] = { 1, 63, 64, 65, 127 };
+    for (size_t i = 0; i < sizeof(sums) / sizeof(sums[0]); i++) {
+        for (size_t j = 0; j < sizeof(shifts) / sizeof(shifts[0]); j++) {
+            make_sumset(&pair.a, sums[i]);
+            pair.x = shifts[j];
+            report_measurement(report, "sumset_add", sumset_kernels.name, sums[i], sumset_live_words(sums[i] + pair.x),
+                pair.x, 0, measure(add_body, &pair));
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(sums) / sizeof(sums[0]); i++) {
+        make_pattern(&pair.a, sums[i], 0x5555555555555555ULL);
+        make_pattern(&pair.b, sums[i], 0xaaaaaaaaaaaaaaaaULL);
+        int words = sumset_live_words(sums[i]);
+        report_measurement(report, "is_sumset_intersection_trivial", sumset_kernels.name, sums[i], words, 0, 0,
+            measure(trivial_body, &pair));
+        report_measurement(report, "get_sumset_intersection_size", sumset_kernels.name, sums[i], words, 0, 0,
+            measure(size_body, &pair));
+    }
+}
+
+// solution_build only follows prev pointers and compares sumsets, it doesn't go through the kernels.
+static void bench_solution_build(Report* report)
+{
+    static const int depths[] = { 8, 32, MAX_D };
+    input_data_init(&pair.input, 1, MAX_D, (int[]) { 0 }, (int[]) { 0 });
+    for (size_t i = 0; i < sizeof(depths) / sizeof(depths[0]); i++) {
+        int depth = depths[i];
+        // Sums stay below MAX_BITS: depth * x <= MAX_D * (MAX_D - 1).
+        int x = MAX_D - 1 < 100 ? MAX_D - 1 : 100;
+        sumset_copy(&chain_a[0], &pair.input.a_start);
+        sumset_copy(&chain_b[0], &pair.input.b_start);
+        for (int k = 1; k <= depth; k++) {
+            sumset_add(&chain_a[k], &chain_a[k - 1], x);
+            sumset_add(&chain_b[k], &chain_b[k - 1], x);
+        }
+        pair.top_a = &chain_a[depth];
+        pair.top_b = &chain_b[depth];
+        int sum = chain_a[depth].sum;
+        report_measurement(report, "solution_build", "none", sum, sumset_live_words(sum), 0, depth,
+            measure(build_body, &pair));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    static const struct option long_options[] = {
+        { "json", required_argument, NULL, 'j' },
+        { NULL, 0, NULL, 0 },
+    };
+    const char* json_path = NULL;
+    int c;
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        if (c != 'j')
+            fatal("usage: %s [--json=FILE]", argv[0]);
+        json_path = optarg;
+    }
+    if (optind != argc)
+        fatal("usage: %s [--json=FILE]", argv[0]);
+
+    static const char* const columns[] = { "benchmark", "kernels", "sum", "words", "x", "depth", "ns_per_op", NULL };
+    Report report;
+    report_begin(&report, columns, json_path);
+    static const char* const variants[] = { "scalar", "avx2", "avx512" };
+    for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        if (sumset_kernels_select(variants[i]))
+            bench_kernels(&report);
+    }
+    bench_solution_build(&report);
+    report_end(&report);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "bench/report.h"
+#include "common/err.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+void report_begin(Report* report, const char* const* columns, const char* json_path)
+{
+    report->columns_count = 0;
+    for (; columns[report->columns_count] != NULL; report->columns_count++) {
+        if (report->columns_count == REPORT_MAX_COLUMNS)
+            fatal("too many report columns");
+        report->columns[report->columns_count] = columns[report->columns_count];
+    }
+    report->rows = 0;
+    report->json = NULL;
+    if (json_path != NULL) {
+        report->json = fopen(json_path, "w");
+        if (report->json == NULL)
+            syserr("cannot open %s", json_path);
+        fprintf(report->json, "[");
+    }
+
+    for (int i = 0; i < report->columns_count; i++)
+        printf("%s%s", i > 0 ? "," : "", report->columns[i]);
+    printf("\n");
+}
+
+// Whether the value is a JSON number (strtod also takes "inf", "nan" and hexadecimal, which JSON doesn't).
+static bool is_number(const char* value)
+{
+    if (!isdigit((unsigned char)value[0]) && value[0] != '-')
+        return false;
+    if (strchr(value, 'x') != NULL || strchr(value, 'X') != NULL)
+        return false;
+    char* end;
+    strtod(value, &end);
+    return *end == '\0';
+}
+
+void report_row(Report* report, const char* const* values)
+{
+    for (int i = 0; i < report->columns_count; i++)
+        printf("%s%s", i > 0 ? "," : "", values[i]);
+    printf("\n");
+    // Rows come in as they're measured, so that a long run can be watched.
+    fflush(stdout);
+
+    if (report->json != NULL) {
+        fprintf(report->json, "%s\n  {", report->rows > 0 ? "," : "");
+        for (int i = 0; i < report->columns_count; i++) {
+            const char* quote = is_number(values[i]) ? "" : "\"";
+            fprintf(report->json, "%s\"%s\": %s%s%s", i > 0 ? ", " : "", report->columns[i], quote, values[i], quote);
+        }
+        fprintf(report->json, "}");
+    }
+    report->rows++;
+}
+
+void report_end(Report* report)
+{
+    if (report->json != NULL) {
+        fprintf(report->json, "\n]\n");
+        if (fclose(report->json) != 0)
+            syserr("cannot write the JSON report");
+    }
+}
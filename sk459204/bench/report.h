@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdio.h>
+
+#define REPORT_MAX_COLUMNS 16
+
+// Results of a benchmark, one row per measurement: CSV on stdout (with a header line), and optionally
+// the same rows as a JSON array of objects in a file. Values are given already formatted; the ones that
+// aren't numbers are quoted in the JSON.
+typedef struct Report {
+    const char* columns[REPORT_MAX_COLUMNS];
+    int columns_count;
+    FILE* json; // NULL if there's no JSON file
+    int rows;
+} Report;
+
+// Start a report with the given columns (a NULL-terminated list), writing JSON to json_path if it's not NULL.
+void report_begin(Report* report, const char* const* columns, const char* json_path);
+
+// Add a row, with one value for each column.
+void report_row(Report* report, const char* const* values);
+
+// Finish the JSON file.
+void report_end(Report* report);
@@ -0,0 +1,268 @@
+// End-to-end benchmark of the solvers on a fixed set of instances, at t = 1, 2, 4, ... up to the number of threads.
+//
+// Usage: bench_scaling [--threads=N] [--repeat=R] [--json=FILE] [--serial=SOLVER]... [--cursors=SOLVER]...
+//                      [--parallel=SOLVER]...
+//
+// Every SOLVER is the path of a solver executable. Serial solvers (reference, nonrecursive) ignore t, so they only
+// run with t = 1, as a baseline; parallel ones run with every t up to N (all cores by default), including N.
+// --cursors solvers (nonrecursive) are serial ones that also run with --cursors=K for K = 2, 4, ... 16 (see
+// Options.cursors), and parallel ones do too, with t = N. Every run is repeated R times (3 by default) and the fastest
+// one is kept. Prints one CSV row per run (and writes the same rows to FILE as JSON, see report.h):
+//   solver,instance,t,cursors,sum,wall_s,nodes,nodes_per_s,speedup,efficiency
+// `nodes` is nodes_expanded from --stats, `speedup` is the wall time of the same solver with t = 1 and one cursor
+// over this one, and `efficiency` is speedup / t. Quits if two runs of an instance disagree on the sum, so that a regression
+// in correctness doesn't pass for one in speed.
+#include "bench/report.h"
+#include "common/err.h"
+#include "common/stats.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SCALING_MAX_SOLVERS 16
+#define SCALING_MAX_CURSORS 16
+
+enum {
+    OPTION_THREADS = 256,
+    OPTION_REPEAT,
+    OPTION_JSON,
+    OPTION_SERIAL,
+    OPTION_CURSORS,
+    OPTION_PARALLEL,
+};
+
+// An instance, as the task input without t, and the solver options to run it with.
+typedef struct Instance {
+    const char* name;
+    const char* input; // "d n m\nA_0\nB_0\n"
+    const char* options; // a single option, or NULL
+} Instance;
+
+// Each takes about a second for the reference solver at -O3 (names end in _bnb when run with -b).
+static const Instance instances[] = {
+    { "d23", "23 0 0\n\n\n", NULL },
+    { "d24_bnb", "24 0 0\n\n\n", "-b" },
+    { "d26_b1_bnb", "26 0 1\n\n1\n", "-b" },
+    { "d34_a2_b3", "34 1 1\n2\n3\n", NULL },
+};
+
+typedef enum SolverKind {
+    SOLVER_SERIAL,
+    SOLVER_CURSORS,
+    SOLVER_PARALLEL,
+} SolverKind;
+
+typedef struct Solver {
+    const char* path;
+    SolverKind kind;
+} Solver;
+
+typedef struct Run {
+    int sum;
+    double wall_s;
+    unsigned long nodes;
+} Run;
+
+static _Noreturn void usage(const char* program)
+{
+    fatal("usage: %s [--threads=N] [--repeat=R] [--json=FILE] [--serial=SOLVER]... [--cursors=SOLVER]...\n"
+          "\t[--parallel=SOLVER]...",
+        program);
+}
+
+static int parse_positive(const char* program, const char* arg)
+{
+    char* end;
+    long number = strtol(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0' || number < 1 || number > 1 << 20)
+        usage(program);
+    return number;
+}
+
+static const char* solver_name(const Solver* solver)
+{
+    const char* slash = strrchr(solver->path, '/');
+    return slash != NULL ? slash + 1 : solver->path;
+}
+
+// A temporary file holding `text`, rewound.
+static FILE* text_file(const char* text)
+{
+    FILE* file = tmpfile();
+    if (file == NULL)
+        syserr("cannot create a temporary file");
+    fputs(text, file);
+    rewind(file);
+    return file;
+}
+
+// Run the solver once on the instance with t threads (and `cursors` cursors, unless it's a SOLVER_SERIAL one),
+// with --stats, and read the sum and the nodes expanded.
+static void run_once(const Solver* solver, const Instance* instance, int t, int cursors, Run* run)
+{
+    char input[256];
+    snprintf(input, sizeof(input), "%d %s", t, instance->input);
+    FILE* in = text_file(input);
+    FILE* out = text_file("");
+    FILE* err = text_file("");
+    char cursors_option[32];
+    snprintf(cursors_option, sizeof(cursors_option), "--cursors=%d", cursors);
+    char* args[5];
+    int n = 0;
+    args[n++] = (char*)solver->path;
+    args[n++] = "--stats";
+    if (solver->kind != SOLVER_SERIAL)
+        args[n++] = cursors_option;
+    if (instance->options != NULL)
+        args[n++] = (char*)instance->options;
+    args[n] = NULL;
+
+    uint64_t start_ns = stats_now_ns();
+    pid_t pid = fork();
+    ASSERT_SYS_OK(pid);
+    if (pid == 0) {
+        ASSERT_SYS_OK(dup2(fileno(in), STDIN_FILENO));
+        ASSERT_SYS_OK(dup2(fileno(out), STDOUT_FILENO));
+        ASSERT_SYS_OK(dup2(fileno(err), STDERR_FILENO));
+        execv(solver->path, args);
+        syserr("cannot run %s", solver->path);
+    }
+    int status;
+    ASSERT_SYS_OK(waitpid(pid, &status, 0));
+    run->wall_s = (stats_now_ns() - start_ns) / 1e9;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        fatal("%s failed on %s with t=%d", solver->path, instance->name, t);
+
+    rewind(out);
+    if (fscanf(out, "%d", &run->sum) != 1)
+        fatal("%s printed no solution for %s", solver->path, instance->name);
+    rewind(err);
+    char line[1024];
+    bool found = false;
+    while (fgets(line, sizeof(line), err) != NULL) {
+        if (sscanf(line, "stats: worker=total nodes_expanded=%lu", &run->nodes) == 1)
+            found = true;
+    }
+    if (!found)
+        fatal("%s printed no stats for %s", solver->path, instance->name);
+    fclose(in);
+    fclose(out);
+    fclose(err);
+}
+
+// The fastest of `repeat` runs.
+static void run_best(const Solver* solver, const Instance* instance, int t, int cursors, int repeat, Run* best)
+{
+    for (int i = 0; i < repeat; i++) {
+        Run run;
+        run_once(solver, instance, t, cursors, &run);
+        if (i > 0 && run.sum != best->sum)
+            fatal("%s: %s gave %d and then %d", instance->name, solver->path, best->sum, run.sum);
+        if (i == 0 || run.wall_s < best->wall_s)
+            *best = run;
+    }
+}
+
+static void report_run(Report* report, const Solver* solver, const Instance* instance, int t, int cursors,
+    const Run* run, double baseline_s)
+{
+    char t_text[16], cursors_text[16], sum_text[16], wall_text[32], nodes_text[32], rate_text[32];
+    char speedup_text[32], efficiency_text[32];
+    snprintf(t_text, sizeof(t_text), "%d", t);
+    snprintf(cursors_text, sizeof(cursors_text), "%d", cursors);
+    snprintf(sum_text, sizeof(sum_text), "%d", run->sum);
+    snprintf(wall_text, sizeof(wall_text), "%.4f", run->wall_s);
+    snprintf(nodes_text, sizeof(nodes_text), "%lu", run->nodes);
+    snprintf(rate_text, sizeof(rate_text), "%.0f", run->nodes / run->wall_s);
+    snprintf(speedup_text, sizeof(speedup_text), "%.3f", baseline_s / run->wall_s);
+    snprintf(efficiency_text, sizeof(efficiency_text), "%.3f", baseline_s / run->wall_s / t);
+    const char* values[] = { solver_name(solver), instance->name, t_text, cursors_text, sum_text, wall_text,
+        nodes_text, rate_text, speedup_text, efficiency_text };
+    report_row(report, values);
+}
+
+int main(int argc, char* argv[])
+{
+    static const struct option long_options[] = {
+        { "threads", required_argument, NULL, OPTION_THREADS },
+        { "repeat", required_argument, NULL, OPTION_REPEAT },
+        { "json", required_argument, NULL, OPTION_JSON },
+        { "serial", required_argument, NULL, OPTION_SERIAL },
+        { "cursors", required_argument, NULL, OPTION_CURSORS },
+        { "parallel", required_argument, NULL, OPTION_PARALLEL },
+        { NULL, 0, NULL, 0 },
+    };
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = cores > 0 ? cores : 1;
+    int repeat = 3;
+    const char* json_path = NULL;
+    Solver solvers[SCALING_MAX_SOLVERS];
+    int solvers_count = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        switch (c) {
+        case OPTION_THREADS:
+            threads = parse_positive(argv[0], optarg);
+            break;
+        case OPTION_REPEAT:
+            repeat = parse_positive(argv[0], optarg);
+            break;
+        case OPTION_JSON:
+            json_path = optarg;
+            break;
+        case OPTION_SERIAL:
+        case OPTION_CURSORS:
+        case OPTION_PARALLEL:
+            if (solvers_count == SCALING_MAX_SOLVERS)
+                fatal("at most %d solvers", SCALING_MAX_SOLVERS);
+            solvers[solvers_count].path = optarg;
+            solvers[solvers_count].kind
+                = c == OPTION_SERIAL ? SOLVER_SERIAL : c == OPTION_CURSORS ? SOLVER_CURSORS : SOLVER_PARALLEL;
+            solvers_count++;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc || solvers_count == 0)
+        usage(argv[0]);
+
+    static const char* const columns[] = { "solver", "instance", "t", "cursors", "sum", "wall_s", "nodes",
+        "nodes_per_s", "speedup", "efficiency", NULL };
+    Report report;
+    report_begin(&report, columns, json_path);
+    for (size_t i = 0; i < sizeof(instances) / sizeof(instances[0]); i++) {
+        const Instance* instance = &instances[i];
+        int sum = -1; // of the first run, every other one must agree
+        for (int s = 0; s < solvers_count; s++) {
+            const Solver* solver = &solvers[s];
+            double baseline_s = 0;
+            int t = 1, cursors = 1;
+            while (true) {
+                Run run;
+                run_best(solver, instance, t, cursors, repeat, &run);
+                if (sum < 0)
+                    sum = run.sum;
+                else if (run.sum != sum)
+                    fatal("%s: %s gave %d with t=%d cursors=%d, %s gave %d", instance->name, solver->path, run.sum, t,
+                        cursors, solvers[0].path, sum);
+                if (t == 1 && cursors == 1)
+                    baseline_s = run.wall_s;
+                report_run(&report, solver, instance, t, cursors, &run, baseline_s);
+                if (solver->kind == SOLVER_PARALLEL && t < threads)
+                    t = 2 * t > threads ? threads : 2 * t;
+                else if (solver->kind != SOLVER_SERIAL && cursors < SCALING_MAX_CURSORS)
+                    cursors *= 2;
+                else
+                    break;
+            }
+        }
+    }
+    report_end(&report);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include "common/bound.h"
+
+#include <string.h>
+
+static int min(int a, int b) { return a < b ? a : b; }
+
+static int max(int a, int b) { return a > b ? a : b; }
+
+int bound_square(const Sumset* a, const Sumset* b, int d)
+{
+    return d * d;
+}
+
+int bound_pigeonhole(const Sumset* a, const Sumset* b, int d)
+{
+    int free_elements = 2 * d - a->size - b->size;
+    if (free_elements < 0)
+        return 0;
+
+    // ∑A ≤ ∑a + d·(|A| - |a|) and ∑B ≤ ∑b + d·(|B| - |b|), where (|A| - |a|) + (|B| - |b|) ≤ free_elements.
+    int bound = (a->sum + b->sum + d * free_elements) / 2;
+    bound = min(bound, a->sum + d * free_elements);
+    bound = min(bound, b->sum + d * free_elements);
+    if (bound < max(a->sum, b->sum))
+        return 0;
+    return bound;
+}
+
+static const struct {
+    const char* name;
+    BoundFunction function;
+} bound_functions[] = {
+    { "pigeonhole", bound_pigeonhole },
+    { "square", bound_square },
+};
+
+const char* const bound_function_names = "pigeonhole, square";
+
+BoundFunction bound_function_by_name(const char* name)
+{
+    for (size_t i = 0; i < sizeof(bound_functions) / sizeof(bound_functions[0]); ++i) {
+        if (strcmp(bound_functions[i].name, name) == 0)
+            return bound_functions[i].function;
+    }
+    return NULL;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "common/sumset.h"
+#include "common/width.h"
+
+#include <stdbool.h>
+
+// Width-specific functions (see width.h).
+#define bound_square WIDTH_NAME(bound_square)
+#define bound_pigeonhole WIDTH_NAME(bound_pigeonhole)
+#define bound_function_by_name WIDTH_NAME(bound_function_by_name)
+#define bound_function_names WIDTH_NAME(bound_function_names)
+
+// An upper bound on ∑A over all undisputed d-bounded pairs A ⊇ a, B ⊇ b that can be reached from the node (a, b).
+// Returning 0 means that no such pair exists. Used for branch-and-bound pruning: a node whose bound
+// doesn't exceed the best sum found so far can't improve the solution.
+typedef int (*BoundFunction)(const Sumset* a, const Sumset* b, int d);
+
+// Always d², the bound below for a node with no elements.
+int bound_square(const Sumset* a, const Sumset* b, int d);
+
+// Walking through A and B, always taking the next element from the side with the smaller running sum,
+// keeps the difference of running sums in [-(d-1), d]. If the pair is undisputed, no difference
+// repeats before the end (the elements in between would form equal sub-sums), so |A| + |B| ≤ 2d.
+// Every element still to be added is at most d, which bounds ∑A = ∑B.
+int bound_pigeonhole(const Sumset* a, const Sumset* b, int d);
+
+// Returns the bound function with the given name, or NULL if there is none.
+BoundFunction bound_function_by_name(const char* name);
+
+// Names of all bound functions, separated by ", " (for usage messages).
+extern const char* const bound_function_names;
@@ -0,0 +1,51 @@
+#include "common/branch.h"
+
+#include <assert.h>
+
+void branch_side_init(BranchSide* side, const InputData* input_data, const Sumset* s)
+{
+    side->last = s->last;
+    multiset_init(&side->added);
+    while (s->prev) {
+        side->added.count[s->sum - s->prev->sum]++;
+        s = s->prev;
+    }
+    // If A_0^Σ = B_0^Σ, either start gives the same sumsets.
+    side->from_b = !sumset_eq(s, &input_data->a_start);
+    assert(!side->from_b || sumset_eq(s, &input_data->b_start));
+}
+
+int branch_side_size(const BranchSide* side)
+{
+    int size = 0;
+    for (int x = 1; x <= MAX_D; x++)
+        size += side->added.count[x];
+    return size;
+}
+
+const Sumset* branch_side_build(const BranchSide* side, const InputData* input_data, Sumset* chain)
+{
+    Sumset* s = chain;
+    sumset_copy(s, side->from_b ? &input_data->b_start : &input_data->a_start);
+    for (int x = 1; x <= input_data->d; x++) {
+        for (int i = 0; i < side->added.count[x]; i++) {
+            sumset_add(s + 1, s, x);
+            s++;
+        }
+    }
+    if (s->last != side->last) {
+        sumset_copy(s + 1, s);
+        s++;
+        s->last = side->last;
+    }
+    return s;
+}
+
+void branch_init(Branch* branch, const InputData* input_data, const Sumset* a, const Sumset* b,
+    const ElementSet* children)
+{
+    branch_side_init(&branch->a, input_data, a);
+    branch_side_init(&branch->b, input_data, b);
+    for (int i = 0; i < ELEMENT_SET_WORDS; i++)
+        branch->children.bits[i] = children ? children->bits[i] : 0;
+}
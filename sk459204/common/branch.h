@@ -0,0 +1,43 @@
+#pragma once
+#include "common/io.h"
+#include "common/sumset.h"
+#include "common/width.h"
+
+#include <stdbool.h>
+
+// Width-specific functions (see width.h).
+#define branch_side_init WIDTH_NAME(branch_side_init)
+#define branch_side_size WIDTH_NAME(branch_side_size)
+#define branch_side_build WIDTH_NAME(branch_side_build)
+#define branch_init WIDTH_NAME(branch_init)
+
+// One side of a node of the search tree, described by how it was reached rather than by its sumset:
+// the start multiset it grew from and the elements added to it. Elements are always added in nondecreasing
+// order (children only add x ≥ last), so the multiset of added elements gives the order too.
+typedef struct BranchSide {
+    bool from_b; // grown from B_0 (otherwise from A_0)
+    int last; // Sumset.last of the side (raised above the last added element for symmetric roots)
+    Multiset added;
+} BranchSide;
+
+// Unexplored work of the search, independent of where the sumsets live in memory, so that it can be
+// written out and rebuilt by another run (see checkpoint.h). If `children` is empty the branch is the open
+// node (a, b) itself, otherwise it's the open children (a ∪ {x}, b) for x in `children`.
+typedef struct Branch {
+    BranchSide a, b;
+    ElementSet children;
+} Branch;
+
+// Describe the side ending with the sumset `s`, whose prev pointers lead to a copy of a_start or b_start.
+void branch_side_init(BranchSide* side, const InputData* input_data, const Sumset* s);
+
+// Number of added elements.
+int branch_side_size(const BranchSide* side);
+
+// Rebuild the side as a chain of sumsets in `chain`, which must have room for branch_side_size(side) + 2
+// of them (the start copy, one per added element, and one for a raised last). Returns the last sumset.
+const Sumset* branch_side_build(const BranchSide* side, const InputData* input_data, Sumset* chain);
+
+// Describe the node (a, b), or its open children (a ∪ {x}, b) for x in `children` if it's not NULL.
+void branch_init(Branch* branch, const InputData* input_data, const Sumset* a, const Sumset* b,
+    const ElementSet* children);
@@ -0,0 +1,110 @@
+#include "common/cache.h"
+#include "common/err.h"
+
+#include <stdlib.h>
+
+#define CACHE_BUCKET_ENTRIES 4
+#define CACHE_BUCKET_BYTES (CACHE_BUCKET_ENTRIES * sizeof(CacheEntry))
+#define CACHE_LAST_BITS 8
+#define CACHE_CHECK_SHIFT (2 * CACHE_LAST_BITS)
+
+_Static_assert(MAX_D < (1 << CACHE_LAST_BITS), "last must fit in an entry");
+_Static_assert(CACHE_BUCKET_BYTES == 64, "a bucket is one cache line");
+
+Cache* cache_create(size_t bytes, int d, int max_sum)
+{
+    uint64_t buckets = 1;
+    while (2 * buckets * CACHE_BUCKET_BYTES <= bytes)
+        buckets *= 2;
+
+    Cache* cache = malloc(sizeof(Cache));
+    if (cache == NULL)
+        fatal("cannot allocate the cache");
+    cache->entries = aligned_alloc(CACHE_BUCKET_BYTES, buckets * CACHE_BUCKET_BYTES);
+    if (cache->entries == NULL)
+        fatal("cannot allocate %lu bytes for the cache", (unsigned long)(buckets * CACHE_BUCKET_BYTES));
+    for (uint64_t i = 0; i < buckets * CACHE_BUCKET_ENTRIES; ++i) {
+        atomic_init(&cache->entries[i].tag, 0);
+        atomic_init(&cache->entries[i].check, 0);
+    }
+    cache->bucket_mask = buckets - 1;
+    cache->max_sum = max_sum > 0 ? max_sum : CACHE_DEFAULT_MAX_SUM(d);
+    return cache;
+}
+
+void cache_destroy(Cache* cache)
+{
+    free(cache->entries);
+    free(cache);
+}
+
+static inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// Finalizer of MurmurHash3.
+static inline uint64_t mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Two independent 64-bit hashes of both sumsets (their live words, the sums delimit them).
+static void cache_hash(const Sumset* a, const Sumset* b, uint64_t* h1, uint64_t* h2)
+{
+    uint64_t x = 0x9e3779b97f4a7c15ULL ^ ((uint64_t)a->sum << 32 | (uint64_t)b->sum);
+    uint64_t y = 0x6a09e667f3bcc909ULL ^ ((uint64_t)b->sum << 32 | (uint64_t)a->sum);
+    const Sumset* sides[2] = { a, b };
+    for (int s = 0; s < 2; ++s) {
+        int words = sumset_live_words(sides[s]->sum);
+        for (int i = 0; i < words; ++i) {
+            Word w = sides[s]->sumset[i];
+            x = rotl((x ^ w) * 0x87c37b91114253d5ULL, 31);
+            y = rotl((y + w) * 0x4cf5ad432745937fULL, 33);
+        }
+    }
+    *h1 = mix(x);
+    *h2 = mix(y ^ x);
+}
+
+static inline int entry_a_last(uint64_t check) { return (check >> CACHE_LAST_BITS) & ((1 << CACHE_LAST_BITS) - 1); }
+
+static inline int entry_b_last(uint64_t check) { return check & ((1 << CACHE_LAST_BITS) - 1); }
+
+bool cache_visit(Cache* cache, const Sumset* a, const Sumset* b)
+{
+    uint64_t h1, h2;
+    cache_hash(a, b, &h1, &h2);
+
+    uint64_t tag = h1 != 0 ? h1 : 1; // 0 marks an empty entry
+    uint64_t check_bits = h2 >> CACHE_CHECK_SHIFT;
+    uint64_t check = check_bits << CACHE_CHECK_SHIFT | (uint64_t)a->last << CACHE_LAST_BITS | (uint64_t)b->last;
+
+    CacheEntry* bucket = &cache->entries[(h2 & cache->bucket_mask) * CACHE_BUCKET_ENTRIES];
+    int victim = -1;
+    for (int i = 0; i < CACHE_BUCKET_ENTRIES; ++i) {
+        uint64_t old_tag = atomic_load_explicit(&bucket[i].tag, memory_order_relaxed);
+        if (old_tag == 0) {
+            if (victim < 0)
+                victim = i;
+            continue;
+        }
+        if (old_tag != tag)
+            continue;
+        uint64_t old = atomic_load_explicit(&bucket[i].check, memory_order_relaxed);
+        if ((old >> CACHE_CHECK_SHIFT) != check_bits)
+            continue;
+        if (entry_a_last(old) <= a->last && entry_b_last(old) <= b->last)
+            return true; // visited with at least the same children
+        if (a->last <= entry_a_last(old) && b->last <= entry_b_last(old))
+            victim = i; // this node dominates the recorded one, replace it
+    }
+
+    if (victim < 0)
+        victim = (h1 >> 62) % CACHE_BUCKET_ENTRIES;
+    atomic_store_explicit(&bucket[victim].tag, tag, memory_order_relaxed);
+    atomic_store_explicit(&bucket[victim].check, check, memory_order_relaxed);
+    return false;
+}
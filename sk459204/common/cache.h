@@ -0,0 +1,62 @@
+#pragma once
+#include "common/sumset.h"
+#include "common/width.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Width-specific functions (see width.h).
+#define cache_create WIDTH_NAME(cache_create)
+#define cache_destroy WIDTH_NAME(cache_destroy)
+#define cache_visit WIDTH_NAME(cache_visit)
+
+// Transposition cache of visited open nodes, shared by all workers.
+//
+// Different multisets can have the same sumset, so a state (A^Σ, B^Σ, lasts) may be reached by several paths.
+// The subtree of an open node (a, b) only depends on the sumsets and the last elements of both sides, and a node
+// with smaller lasts has a superset of the children, so a node can be skipped once a node with the same sumsets and
+// lasts not larger than its own has been visited (explored or pruned, by any worker).
+//
+// Each entry is two 64-bit words holding 112 bits of a 128-bit hash of both sumsets: one 64-bit half, and the top 48
+// bits of the other half next to both lasts. The low bits of that other half pick a bucket of 4 entries (one cache
+// line). Entries are read and written with relaxed atomics, word by word: a racing update can lose an entry, or tear
+// it into the words of two entries, which then matches neither. Two different states are only confused when all 112
+// bits are equal, about 2^-110 per lookup, so a wrong hit (which would skip a live subtree) isn't expected in any
+// search this solver can finish.
+typedef struct CacheEntry {
+    _Atomic(uint64_t) tag; // one half of the hash (never 0), 0 for an empty entry
+    _Atomic(uint64_t) check; // top 48 bits of the other half, then a's last and b's last in 8 bits each
+} CacheEntry;
+
+typedef struct Cache {
+    CacheEntry* entries;
+    uint64_t bucket_mask; // number of buckets - 1, a power of two
+
+    // Only nodes with ∑b at most this are looked up (see CACHE_DEFAULT_MAX_SUM).
+    int max_sum;
+} Cache;
+
+// Looking up a node costs a hash of all its live words and a cache miss, which is more than exploring a small
+// subtree again, and the number of nodes grows quickly with the sums, so that deep nodes would evict the shallow
+// ones worth keeping. Measured on one core (d = 22 and 28, d = 24 and 26 with -b, 64 MB), looking up nodes with
+// ∑b ≤ d²/10 was 15-60% slower than no cache, and ∑b ≤ d²/20 was 5-14% faster, except for d = 28 with non-empty
+// starts, where any cutoff is a loss. The best cutoff depends on the machine and the instance (--cache-max-sum).
+#define CACHE_DEFAULT_MAX_SUM(d) ((d) * (d) / 20)
+
+// Create a cache for d-bounded pairs using at most `bytes` of memory (at least one bucket), looking up nodes with
+// ∑b ≤ max_sum (CACHE_DEFAULT_MAX_SUM(d) if 0).
+Cache* cache_create(size_t bytes, int d, int max_sum);
+
+void cache_destroy(Cache* cache);
+
+// Whether the node (a, b) (with ∑a ≤ ∑b) should be looked up at all.
+static inline bool cache_covers(const Cache* cache, const Sumset* b)
+{
+    return b->sum <= cache->max_sum;
+}
+
+// Return true if (a, b) (with ∑a ≤ ∑b) or a node dominating it was already visited.
+// Otherwise record (a, b) as visited (the caller must then explore or prune it) and return false.
+bool cache_visit(Cache* cache, const Sumset* a, const Sumset* b);
@@ -0,0 +1,297 @@
+#include "common/checkpoint.h"
+#include "common/err.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Format, one item per line:
+//   sumset-checkpoint 1
+//   input <d> <A_0> <B_0>
+//   best <sum> <A> <B>
+//   stats <the fields of Stats, in order>
+//   branches <count>
+//   <a side> <b side> <children>      (count times)
+// A multiset is "<k> x_1 c_1 ... x_k c_k" (element, count), a side is "<a|b> <last> <added multiset>"
+// and children are "<k> x_1 ... x_k".
+#define CHECKPOINT_MAGIC "sumset-checkpoint"
+#define CHECKPOINT_VERSION 1
+
+void checkpoint_init(Checkpoint* checkpoint)
+{
+    solution_init(&checkpoint->best);
+    stats_init(&checkpoint->stats);
+    checkpoint->branches = NULL;
+    checkpoint->branches_count = 0;
+    checkpoint->branches_size = 0;
+}
+
+void checkpoint_destroy(Checkpoint* checkpoint)
+{
+    free(checkpoint->branches);
+}
+
+void checkpoint_add(Checkpoint* checkpoint, const Branch* branch)
+{
+    if (checkpoint->branches_count == checkpoint->branches_size) {
+        checkpoint->branches_size = checkpoint->branches_size ? 2 * checkpoint->branches_size : 64;
+        checkpoint->branches = realloc(checkpoint->branches, checkpoint->branches_size * sizeof(Branch));
+        if (checkpoint->branches == NULL)
+            fatal("cannot allocate %d checkpoint branches", checkpoint->branches_size);
+    }
+    checkpoint->branches[checkpoint->branches_count++] = *branch;
+}
+
+int checkpoint_bound(const Checkpoint* checkpoint, const InputData* input_data, BoundFunction bound)
+{
+    int largest = 0;
+    for (int i = 0; i < checkpoint->branches_count; i++) {
+        const Branch* branch = &checkpoint->branches[i];
+        Sumset* a_chain = malloc((branch_side_size(&branch->a) + 2) * sizeof(Sumset));
+        Sumset* b_chain = malloc((branch_side_size(&branch->b) + 2) * sizeof(Sumset));
+        if (a_chain == NULL || b_chain == NULL)
+            fatal("cannot allocate a branch");
+        const Sumset* a = branch_side_build(&branch->a, input_data, a_chain);
+        const Sumset* b = branch_side_build(&branch->b, input_data, b_chain);
+        if (element_set_is_empty(&branch->children)) {
+            int node_bound = bound(a, b, input_data->d);
+            if (node_bound > largest)
+                largest = node_bound;
+        }
+        ElementSet children = branch->children;
+        Sumset child;
+        while (!element_set_is_empty(&children)) {
+            sumset_add(&child, a, element_set_pop_min(&children));
+            int child_bound = bound(&child, b, input_data->d);
+            if (child_bound > largest)
+                largest = child_bound;
+        }
+        free(a_chain);
+        free(b_chain);
+    }
+    return largest;
+}
+
+static void write_multiset(FILE* file, const Multiset* v)
+{
+    int k = 0;
+    for (int x = 1; x <= MAX_D; x++)
+        k += v->count[x] != 0;
+    fprintf(file, "%d", k);
+    for (int x = 1; x <= MAX_D; x++)
+        if (v->count[x])
+            fprintf(file, " %d %d", x, v->count[x]);
+}
+
+static void write_side(FILE* file, const BranchSide* side)
+{
+    fprintf(file, "%s %d ", side->from_b ? "b" : "a", side->last);
+    write_multiset(file, &side->added);
+}
+
+void checkpoint_write_input(FILE* file, const InputData* input_data)
+{
+    fprintf(file, "%d ", input_data->d);
+    write_multiset(file, &input_data->a_in);
+    fprintf(file, " ");
+    write_multiset(file, &input_data->b_in);
+}
+
+void checkpoint_write_solution(FILE* file, const Solution* solution)
+{
+    fprintf(file, "%d ", solution->sum);
+    write_multiset(file, &solution->a);
+    fprintf(file, " ");
+    write_multiset(file, &solution->b);
+}
+
+void checkpoint_write_stats(FILE* file, const Stats* stats)
+{
+    fprintf(file, "%lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %" PRIu64 " %" PRIu64 " %" PRIu64,
+        stats->nodes_expanded, stats->children_generated, stats->children_rejected, stats->terminal_checks,
+        stats->pruned, stats->cache_hits, stats->cache_misses, stats->pool_allocs, stats->branches_given,
+        stats->branches_taken, stats->idle_ns, stats->lock_wait_ns, stats->run_ns);
+}
+
+void checkpoint_write_branch(FILE* file, const Branch* branch)
+{
+    write_side(file, &branch->a);
+    fprintf(file, " ");
+    write_side(file, &branch->b);
+    ElementSet children = branch->children;
+    fprintf(file, " %d", element_set_size(&children));
+    while (!element_set_is_empty(&children))
+        fprintf(file, " %d", element_set_pop_min(&children));
+}
+
+void checkpoint_write(const Checkpoint* checkpoint, const char* path, const InputData* input_data)
+{
+    size_t length = strlen(path);
+    char* tmp_path = malloc(length + sizeof(".tmp"));
+    if (tmp_path == NULL)
+        fatal("cannot allocate a path");
+    memcpy(tmp_path, path, length);
+    memcpy(tmp_path + length, ".tmp", sizeof(".tmp"));
+
+    FILE* file = fopen(tmp_path, "w");
+    if (file == NULL)
+        syserr("cannot create checkpoint %s", tmp_path);
+
+    fprintf(file, "%s %d\n", CHECKPOINT_MAGIC, CHECKPOINT_VERSION);
+    fprintf(file, "input ");
+    checkpoint_write_input(file, input_data);
+    fprintf(file, "\nbest ");
+    checkpoint_write_solution(file, &checkpoint->best);
+    fprintf(file, "\nstats ");
+    checkpoint_write_stats(file, &checkpoint->stats);
+    fprintf(file, "\nbranches %d\n", checkpoint->branches_count);
+    for (int i = 0; i < checkpoint->branches_count; i++) {
+        checkpoint_write_branch(file, &checkpoint->branches[i]);
+        fprintf(file, "\n");
+    }
+
+    if (fflush(file) != 0 || ferror(file) || fsync(fileno(file)) != 0)
+        syserr("cannot write checkpoint %s", tmp_path);
+    if (fclose(file) != 0)
+        syserr("cannot write checkpoint %s", tmp_path);
+    if (rename(tmp_path, path) != 0)
+        syserr("cannot rename checkpoint %s to %s", tmp_path, path);
+    free(tmp_path);
+}
+
+static _Noreturn void malformed(const char* path)
+{
+    fatal("checkpoint %s is malformed", path);
+}
+
+static bool read_word(FILE* file, const char* expected)
+{
+    char word[32];
+    return fscanf(file, "%31s", word) == 1 && strcmp(word, expected) == 0;
+}
+
+static bool read_int(FILE* file, int min, int max, int* value)
+{
+    return fscanf(file, "%d", value) == 1 && min <= *value && *value <= max;
+}
+
+static bool read_multiset(FILE* file, int d, Multiset* v)
+{
+    multiset_init(v);
+    int k, x;
+    if (!read_int(file, 0, d, &k))
+        return false;
+    for (int i = 0; i < k; i++) {
+        if (!read_int(file, 1, d, &x) || !read_int(file, 1, d * d, &v->count[x]))
+            return false;
+    }
+    return true;
+}
+
+static bool multiset_eq(const Multiset* a, const Multiset* b)
+{
+    return memcmp(a->count, b->count, sizeof(a->count)) == 0;
+}
+
+static bool read_side(FILE* file, int d, BranchSide* side)
+{
+    char start[2];
+    if (fscanf(file, "%1s", start) != 1 || (start[0] != 'a' && start[0] != 'b'))
+        return false;
+    side->from_b = start[0] == 'b';
+    return read_int(file, 1, d, &side->last) && read_multiset(file, d, &side->added);
+}
+
+bool checkpoint_read_input(FILE* file, const InputData* input_data, bool* same)
+{
+    int d;
+    Multiset a_in, b_in;
+    if (!read_int(file, 3, MAX_D, &d))
+        return false;
+    if (d != input_data->d) {
+        // The multisets can't be read without knowing their width, and don't matter anyway.
+        *same = false;
+        return true;
+    }
+    if (!read_multiset(file, d, &a_in) || !read_multiset(file, d, &b_in))
+        return false;
+    *same = multiset_eq(&a_in, &input_data->a_in) && multiset_eq(&b_in, &input_data->b_in);
+    return true;
+}
+
+bool checkpoint_read_solution(FILE* file, int d, Solution* solution)
+{
+    return read_int(file, 0, d * d, &solution->sum) && read_multiset(file, d, &solution->a)
+        && read_multiset(file, d, &solution->b);
+}
+
+bool checkpoint_read_stats(FILE* file, Stats* stats)
+{
+    return fscanf(file, "%lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %" SCNu64 " %" SCNu64 " %" SCNu64,
+               &stats->nodes_expanded, &stats->children_generated, &stats->children_rejected, &stats->terminal_checks,
+               &stats->pruned, &stats->cache_hits, &stats->cache_misses, &stats->pool_allocs, &stats->branches_given,
+               &stats->branches_taken, &stats->idle_ns, &stats->lock_wait_ns, &stats->run_ns)
+        == 13;
+}
+
+bool checkpoint_read_branch(FILE* file, int d, Branch* branch)
+{
+    if (!read_side(file, d, &branch->a) || !read_side(file, d, &branch->b))
+        return false;
+    for (int j = 0; j < ELEMENT_SET_WORDS; j++)
+        branch->children.bits[j] = 0;
+    int k, x;
+    if (!read_int(file, 0, d, &k))
+        return false;
+    for (int j = 0; j < k; j++) {
+        if (!read_int(file, 1, d, &x))
+            return false;
+        branch->children.bits[x / BITS_PER_WORD] |= ((Word)1) << (x % BITS_PER_WORD);
+    }
+    return true;
+}
+
+bool checkpoint_read(Checkpoint* checkpoint, const char* path, const InputData* input_data)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        if (errno == ENOENT)
+            return false;
+        syserr("cannot open checkpoint %s", path);
+    }
+
+    int d = input_data->d;
+    int version, count;
+    bool same_input;
+    if (!read_word(file, CHECKPOINT_MAGIC) || !read_int(file, 0, CHECKPOINT_VERSION, &version)
+        || version != CHECKPOINT_VERSION)
+        malformed(path);
+
+    if (!read_word(file, "input") || !checkpoint_read_input(file, input_data, &same_input))
+        malformed(path);
+    if (!same_input)
+        fatal("checkpoint %s was written for a different input", path);
+
+    if (!read_word(file, "best") || !checkpoint_read_solution(file, d, &checkpoint->best))
+        malformed(path);
+    if (!read_word(file, "stats") || !checkpoint_read_stats(file, &checkpoint->stats))
+        malformed(path);
+
+    if (!read_word(file, "branches") || !read_int(file, 0, __INT_MAX__, &count))
+        malformed(path);
+    for (int i = 0; i < count; i++) {
+        Branch branch;
+        if (!checkpoint_read_branch(file, d, &branch))
+            malformed(path);
+        checkpoint_add(checkpoint, &branch);
+    }
+
+    char extra[2];
+    if (fscanf(file, "%1s", extra) != EOF)
+        malformed(path);
+    fclose(file);
+    return true;
+}
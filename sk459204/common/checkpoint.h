@@ -0,0 +1,71 @@
+#pragma once
+#include "common/bound.h"
+#include "common/branch.h"
+#include "common/io.h"
+#include "common/stats.h"
+#include "common/width.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Width-specific functions (see width.h).
+#define checkpoint_init WIDTH_NAME(checkpoint_init)
+#define checkpoint_destroy WIDTH_NAME(checkpoint_destroy)
+#define checkpoint_add WIDTH_NAME(checkpoint_add)
+#define checkpoint_bound WIDTH_NAME(checkpoint_bound)
+#define checkpoint_read WIDTH_NAME(checkpoint_read)
+#define checkpoint_write WIDTH_NAME(checkpoint_write)
+#define checkpoint_write_input WIDTH_NAME(checkpoint_write_input)
+#define checkpoint_write_solution WIDTH_NAME(checkpoint_write_solution)
+#define checkpoint_write_stats WIDTH_NAME(checkpoint_write_stats)
+#define checkpoint_write_branch WIDTH_NAME(checkpoint_write_branch)
+#define checkpoint_read_input WIDTH_NAME(checkpoint_read_input)
+#define checkpoint_read_solution WIDTH_NAME(checkpoint_read_solution)
+#define checkpoint_read_stats WIDTH_NAME(checkpoint_read_stats)
+#define checkpoint_read_branch WIDTH_NAME(checkpoint_read_branch)
+
+// A snapshot of a search in progress, so that it can be resumed once the process is gone (a reboot, an OOM kill):
+// the best solution so far, the counters, and the unexplored frontier as branches (see branch.h). Branches don't
+// depend on the engine nor on the number of threads, so a checkpoint can be resumed by any implementation.
+//
+// Checkpoints are small text files. They're written to `path`.tmp first and then renamed to `path`,
+// so a crash while writing leaves the previous checkpoint intact.
+typedef struct Checkpoint {
+    Solution best;
+    Stats stats; // counters of all runs so far, with run_ns summed over them (see stats_add_run)
+    Branch* branches;
+    int branches_count;
+    int branches_size;
+} Checkpoint;
+
+// Initialize an empty checkpoint (no solution, no counters, no branches).
+void checkpoint_init(Checkpoint* checkpoint);
+
+void checkpoint_destroy(Checkpoint* checkpoint);
+
+// Append a copy of the branch to the frontier.
+void checkpoint_add(Checkpoint* checkpoint, const Branch* branch);
+
+// The largest bound of the open nodes of the frontier (0 if there are none): no solution still to be found
+// by exploring it has a larger sum.
+int checkpoint_bound(const Checkpoint* checkpoint, const InputData* input_data, BoundFunction bound);
+
+// Read the checkpoint at `path` into an initialized checkpoint. Returns false if there's no file at `path`,
+// quits if the file is malformed or was written for a different input (d, A_0, B_0).
+bool checkpoint_read(Checkpoint* checkpoint, const char* path, const InputData* input_data);
+
+// Write the checkpoint to `path`, atomically replacing the previous one (quits on I/O errors).
+void checkpoint_write(const Checkpoint* checkpoint, const char* path, const InputData* input_data);
+
+// The text forms of the parts of a checkpoint, also used by the messages between a coordinator and its workers
+// (see remote.h). Writers add no surrounding whitespace; readers return false if the text is malformed.
+void checkpoint_write_input(FILE* file, const InputData* input_data); // d, A_0 and B_0
+void checkpoint_write_solution(FILE* file, const Solution* solution);
+void checkpoint_write_stats(FILE* file, const Stats* stats);
+void checkpoint_write_branch(FILE* file, const Branch* branch);
+
+// Sets `same` to whether the input read is the one of input_data.
+bool checkpoint_read_input(FILE* file, const InputData* input_data, bool* same);
+bool checkpoint_read_solution(FILE* file, int d, Solution* solution);
+bool checkpoint_read_stats(FILE* file, Stats* stats);
+bool checkpoint_read_branch(FILE* file, int d, Branch* branch);
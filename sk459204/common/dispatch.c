@@ -0,0 +1,23 @@
+#include "common/err.h"
+#include "common/task.h"
+#include "common/width.h"
+
+// main() of every solver: reads the task input, then runs the solver compiled for the smallest width that fits it.
+int main(int argc, char* argv[])
+{
+    TaskInput task;
+    task_input_read(&task, SUMSET_MAX_WIDTH);
+    int width = task_input_width(&task);
+    if (width == 0)
+        fatal("the sums of A_0 and B_0 must be below %d", SUMSET_MAX_WIDTH * SUMSET_MAX_WIDTH);
+
+    int result = 0;
+#define RUN_IF_WIDTH(w)                                         \
+    if (width == w)                                             \
+        result = solver_main_d##w(argc, argv, &task);
+    SUMSET_FOR_EACH_WIDTH(RUN_IF_WIDTH)
+#undef RUN_IF_WIDTH
+
+    task_input_destroy(&task);
+    return result;
+}
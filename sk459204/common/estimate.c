@@ -0,0 +1,148 @@
+#include "common/estimate.h"
+#include "common/err.h"
+#include "common/stats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ESTIMATE_SEED 0x5eed5eed5eed5eedULL
+
+// splitmix64, good enough for choosing children and the same everywhere.
+static uint64_t next_random(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Remove and return a uniformly random element of a set of `size` elements.
+static int pop_random(ElementSet* set, int size, uint64_t* random)
+{
+    for (int skip = next_random(random) % size; skip > 0; skip--)
+        element_set_pop_min(set);
+    return element_set_pop_min(set);
+}
+
+// Whether the open node (a, b) is expanded, and if so its open children.
+static bool expand(const InputData* input_data, const Sumset* a, const Sumset* b, BoundFunction bound, int best_sum,
+    ElementSet* open)
+{
+    if (bound != NULL && bound(a, b, input_data->d) <= best_sum)
+        return false;
+    SumsetChildren children;
+    sumset_expand(a, b, input_data->d, &children);
+    *open = children.open;
+    return true;
+}
+
+// One walk down from the node, see estimate_node. Only the current node is kept: sumsets in `sides` are overwritten
+// as the walk goes (their prev pointers aren't followed, nothing is recovered from them).
+static double probe(const InputData* input_data, const Sumset* a, const Sumset* b, const ElementSet* children,
+    bool symmetric, BoundFunction bound, int best_sum, uint64_t* random)
+{
+    Sumset sides[3];
+    Sumset* small = &sides[0];
+    Sumset* large = &sides[1];
+    Sumset* spare = &sides[2];
+    sumset_copy(small, a);
+    sumset_copy(large, b);
+
+    double nodes = 0;
+    double paths = 1; // nodes at the current depth, as far as this walk can tell
+    ElementSet open;
+    if (children != NULL) {
+        open = *children;
+    } else {
+        if (!expand(input_data, small, large, bound, best_sum, &open))
+            return 0;
+        nodes = 1;
+    }
+
+    for (int size = element_set_size(&open); size > 0; size = element_set_size(&open)) {
+        paths *= size;
+        int x = pop_random(&open, size, random);
+        sumset_add(spare, small, x);
+        if (symmetric) {
+            large->last = x;
+            symmetric = false;
+        }
+        Sumset* child = spare;
+        spare = small;
+        small = child;
+        if (small->sum > large->sum) {
+            small = large;
+            large = child;
+        }
+        if (!expand(input_data, small, large, bound, best_sum, &open))
+            break;
+        nodes += paths;
+    }
+    return nodes;
+}
+
+double estimate_node(const InputData* input_data, const Sumset* a, const Sumset* b, const ElementSet* children,
+    bool symmetric, BoundFunction bound, int best_sum, int probes)
+{
+    if (children == NULL && a->sum > b->sum) {
+        const Sumset* tmp = a;
+        a = b;
+        b = tmp;
+    }
+    uint64_t random = ESTIMATE_SEED;
+    double nodes = 0;
+    for (int i = 0; i < probes; i++)
+        nodes += probe(input_data, a, b, children, symmetric, bound, best_sum, &random);
+    return probes > 0 ? nodes / probes : 0;
+}
+
+double estimate_branch(const InputData* input_data, const Branch* branch, BoundFunction bound, int best_sum,
+    int probes)
+{
+    Sumset* a_chain = malloc((branch_side_size(&branch->a) + 2) * sizeof(Sumset));
+    Sumset* b_chain = malloc((branch_side_size(&branch->b) + 2) * sizeof(Sumset));
+    if (a_chain == NULL || b_chain == NULL)
+        fatal("cannot allocate a branch");
+    const Sumset* a = branch_side_build(&branch->a, input_data, a_chain);
+    const Sumset* b = branch_side_build(&branch->b, input_data, b_chain);
+    double nodes = estimate_node(input_data, a, b,
+        element_set_is_empty(&branch->children) ? NULL : &branch->children, false, bound, best_sum, probes);
+    free(a_chain);
+    free(b_chain);
+    return nodes;
+}
+
+double estimate_search(const InputData* input_data, const Options* options, const Checkpoint* resumed)
+{
+    uint64_t start_ns = stats_now_ns();
+    int probes = options->estimate_probes;
+    double nodes = 0;
+    if (resumed == NULL) {
+        const Sumset* a = &input_data->a_start;
+        const Sumset* b = &input_data->b_start;
+        if (input_data_start_kind(input_data) == SUMSET_NODE_OPEN)
+            nodes = estimate_node(input_data, a, b, NULL, sumset_node_is_symmetric(a, b), options->bound, 0, probes);
+    } else {
+        nodes = resumed->stats.nodes_expanded;
+        int branch_probes = resumed->branches_count > 0 ? probes / resumed->branches_count : 0;
+        if (branch_probes < 1)
+            branch_probes = 1;
+        for (int i = 0; i < resumed->branches_count; i++)
+            nodes += estimate_branch(input_data, &resumed->branches[i], options->bound, resumed->best.sum,
+                branch_probes);
+    }
+    fprintf(stderr, "estimate: nodes=%.0f probes=%d estimate_s=%.3f\n", nodes, probes,
+        (stats_now_ns() - start_ns) / 1e9);
+    return nodes;
+}
+
+void estimate_print_progress(double estimated_nodes, unsigned long nodes, unsigned long earlier_nodes, uint64_t run_ns)
+{
+    double done = estimated_nodes > 0 ? 100.0 * nodes / estimated_nodes : 100.0;
+    fprintf(stderr, "progress: nodes=%lu estimated_nodes=%.0f done=%.1f%% run_s=%.1f eta_s=", nodes, estimated_nodes,
+        done < 100.0 ? done : 100.0, run_ns / 1e9);
+    if (nodes > earlier_nodes && nodes < estimated_nodes)
+        fprintf(stderr, "%.0f\n", (estimated_nodes - nodes) * (run_ns / 1e9) / (nodes - earlier_nodes));
+    else
+        fprintf(stderr, "unknown\n");
+}
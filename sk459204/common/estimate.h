@@ -0,0 +1,52 @@
+#pragma once
+#include "common/bound.h"
+#include "common/branch.h"
+#include "common/checkpoint.h"
+#include "common/io.h"
+#include "common/options.h"
+#include "common/width.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Width-specific functions (see width.h).
+#define estimate_node WIDTH_NAME(estimate_node)
+#define estimate_branch WIDTH_NAME(estimate_branch)
+#define estimate_search WIDTH_NAME(estimate_search)
+#define estimate_print_progress WIDTH_NAME(estimate_print_progress)
+
+// Tree-size estimation (Knuth, "Estimating the efficiency of backtrack programs", 1975): a probe walks down from a
+// node along random open children, choosing uniformly among the open children of each node it expands, with the
+// same branching rule as the search (sumset_expand). If the i-th node of the walk has c_i open children, the walk
+// estimates the number of expanded nodes as 1 + c_0 + c_0·c_1 + ..., and the mean of this over all walks is exactly
+// the size of the tree. Probes are averaged; they are cheap (one expansion per level) but the variance is large
+// on unbalanced trees, so take thousands of them for a whole search.
+//
+// The walks ignore the cache and only prune with a fixed best sum, so under branch-and-bound they overestimate
+// the search, which keeps raising its best sum. The random generator is seeded the same way on every call, so that
+// estimates are reproducible (shards depend on it, see shard.h).
+#define ESTIMATE_DEFAULT_PROBES 10000
+
+// Estimated number of nodes expanded when exploring the open node (a, b), or only its open children (a ∪ {x}, b)
+// for x in `children` if that's not NULL (then with ∑a ≤ ∑b), from `probes` walks. Children of a symmetric node get
+// a copy of b with last raised (see sumset_node_is_symmetric). Nodes whose bound doesn't exceed `best_sum` aren't
+// expanded, pass a NULL bound to expand all of them.
+double estimate_node(const InputData* input_data, const Sumset* a, const Sumset* b, const ElementSet* children,
+    bool symmetric, BoundFunction bound, int best_sum, int probes);
+
+// Same for a branch (see branch.h).
+double estimate_branch(const InputData* input_data, const Branch* branch, BoundFunction bound, int best_sum,
+    int probes);
+
+// Estimated number of nodes expanded by the search of `options` from the start node, or from the branches
+// of `resumed` (and its best solution) if it's not NULL, plus the ones counted in resumed->stats. Spends about
+// options->estimate_probes walks on it, split evenly between the branches, and prints the estimate to stderr, e.g.
+//   estimate: nodes=123456 probes=1000 estimate_s=0.012
+double estimate_search(const InputData* input_data, const Options* options, const Checkpoint* resumed);
+
+// Print a progress report to stderr, e.g.
+//   progress: nodes=1234 estimated_nodes=123456 done=1.0% run_s=10.0 eta_s=990
+// given the estimate of estimate_search, the nodes expanded so far (including those of earlier runs, `earlier_nodes`
+// of them) and how long this run has taken. The ETA assumes the rate of this run; it's "unknown" once the search
+// has outgrown the estimate.
+void estimate_print_progress(double estimated_nodes, unsigned long nodes, unsigned long earlier_nodes, uint64_t run_ns);
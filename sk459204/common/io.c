@@ -7,7 +7,7 @@
 
 void multiset_init(Multiset* v)
 {
-    for (int i = 0; i < MAX_D; i++)
+    for (int i = 0; i <= MAX_D; i++)
         v->count[i] = 0;
 }
 
@@ -18,18 +18,15 @@ static void multiset_add(Multiset* a, const Multiset* b)
         a->count[i] += b->count[i];
 }
 
-// Read n elements from stdin, recording them in a Multiset and the corresponding Sumset.
+// Record n elements in a Multiset and the corresponding Sumset.
 // The resulting sumset has prev=NULL and last=1.
-static void read_multiset(int n, Multiset* v, Sumset* s)
+static void load_multiset(int n, const int elements[], Multiset* v, Sumset* s)
 {
     multiset_init(v);
     sumset_init(s);
     for (int i = 0; i < n; i++) {
-        int x;
-        if (scanf("%d", &x) != 1)
-            fatal("scanf");
-        v->count[x]++;
-        _sumset_add(s, s, x);
+        v->count[elements[i]]++;
+        _sumset_add(s, s, elements[i]);
     }
 }
 
@@ -37,6 +34,7 @@ void input_data_init(InputData* input_data, int t, int d, int a_elements[], int
 {
     input_data->t = t;
     input_data->d = d;
+    input_data->bounded = true;
     multiset_init(&input_data->a_in);
     multiset_init(&input_data->b_in);
     sumset_init(&input_data->a_start);
@@ -52,17 +50,14 @@ void input_data_init(InputData* input_data, int t, int d, int a_elements[], int
 }
 
 
-void input_data_read(InputData* input_data)
+void input_data_load(InputData* input_data, const TaskInput* task)
 {
-    int t, d, n, m;
-    if (scanf("%d%d%d%d", &t, &d, &n, &m) != 4)
-        fatal("scanf");
-    assert((3 <= d) && (d <= MAX_D));
-    assert((0 <= n) && (0 <= m));
-    input_data->t = t;
-    input_data->d = d;
-    read_multiset(n, &input_data->a_in, &input_data->a_start);
-    read_multiset(m, &input_data->b_in, &input_data->b_start);
+    assert((3 <= task->d) && (task->d <= MAX_D));
+    input_data->t = task->t;
+    input_data->d = task->d;
+    input_data->bounded = task->bounded;
+    load_multiset(task->bounded ? task->n : 0, task->a, &input_data->a_in, &input_data->a_start);
+    load_multiset(task->bounded ? task->m : 0, task->b, &input_data->b_in, &input_data->b_start);
 }
 
 void solution_init(Solution* s)
@@ -92,34 +87,20 @@ static void _multiset_swap(Multiset* a, Multiset* b)
     *b = tmp;
 }
 
-// Compares the sumsets by value (A^Σ=B^Σ), ignoring last and prev pointers.
-static bool _sumset_eq(const Sumset* a, const Sumset* b)
-{
-    if (a == b)
-        return true;
-    if (a->sum != b->sum)
-        return false;
-    for (int i = 0; i < MAX_WORDS; i++) {
-        if (a->sumset[i] != b->sumset[i])
-            return false;
-    }
-    return true;
-}
-
-void solution_build(Solution* s, InputData* input_data, const Sumset* a, const Sumset* b)
+void solution_build(Solution* s, const InputData* input_data, const Sumset* a, const Sumset* b)
 {
     s->sum = a->sum;
     const Sumset* start_a = _multiset_of_added_elements_from_sumset(&s->a, a);
     const Sumset* start_b = _multiset_of_added_elements_from_sumset(&s->b, b);
     (void) start_b;  // Avoid unused variable warning.
 
-    if (_sumset_eq(start_a, &input_data->a_start)) {
+    if (sumset_eq(start_a, &input_data->a_start)) {
         multiset_add(&s->a, &input_data->a_in);
-        assert(_sumset_eq(start_b, &input_data->b_start));
+        assert(sumset_eq(start_b, &input_data->b_start));
         multiset_add(&s->b, &input_data->b_in);
     } else {
-        assert(_sumset_eq(start_a, &input_data->b_start));
-        assert(_sumset_eq(start_b, &input_data->a_start));
+        assert(sumset_eq(start_a, &input_data->b_start));
+        assert(sumset_eq(start_b, &input_data->a_start));
         multiset_add(&s->a, &input_data->b_in);
         multiset_add(&s->b, &input_data->a_in);
         _multiset_swap(&s->a, &s->b);
@@ -130,7 +111,7 @@ void solution_build(Solution* s, InputData* input_data, const Sumset* a, const S
 static void multiset_print(const Multiset* v)
 {
     bool first = true;
-    for (int i = 0; i < MAX_D; i++) {
+    for (int i = 0; i <= MAX_D; i++) {
         if (v->count[i]) {
             if (first)
                 first = false;
@@ -149,4 +130,12 @@ void solution_print(const Solution* s)
     printf("%d\n", s->sum);
     multiset_print(&s->a);
     multiset_print(&s->b);
+}
+
+void target_print(int target, const Solution* s, bool complete, unsigned long nodes, unsigned long pruned)
+{
+    const char* verdict = s->sum >= target ? "reached" : complete ? "refuted" : "unknown";
+    printf("target=%d verdict=%s nodes=%lu pruned=%lu\n", target, verdict, nodes, pruned);
+    if (s->sum >= target)
+        solution_print(s);
 }
\ No newline at end of file
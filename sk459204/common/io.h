@@ -1,5 +1,16 @@
 #pragma once
 #include "common/sumset.h"
+#include "common/task.h"
+#include "common/width.h"
+
+// Width-specific functions (see width.h).
+#define multiset_init WIDTH_NAME(multiset_init)
+#define input_data_load WIDTH_NAME(input_data_load)
+#define input_data_init WIDTH_NAME(input_data_init)
+#define solution_init WIDTH_NAME(solution_init)
+#define solution_build WIDTH_NAME(solution_build)
+#define solution_print WIDTH_NAME(solution_print)
+#define target_print WIDTH_NAME(target_print)
 
 typedef struct Multiset {
     int count[MAX_D + 1]; // count[i] represents the number of i in the multiset.
@@ -14,12 +25,21 @@ typedef struct InputData {
     Sumset a_start, b_start;  // Representation of the corresponding initial sumsets A_0^Σ, B_0^Σ.
     int t; // Number of threads that can be used.
     int d; // Maximum element allowed in the multisets.
+    bool bounded; // Whether A_0 and B_0 are d-bounded, otherwise they're left empty and α(d, A_0, B_0) = 0.
 } InputData;
 
 
-// Initialize input_data and read the task input (t, d, n, m, A_0, B_0) from stdin into it.
+// Initialize input_data from the task input (t, d, n, m, A_0, B_0) read from stdin (see task.h).
 // The resulting sumsets a_start and b_start have prev=NULL and last=1.
-void input_data_read(InputData* input_data);
+void input_data_load(InputData* input_data, const TaskInput* task);
+
+// Classify the start node (a_start, b_start), which is dead if A_0 and B_0 aren't d-bounded.
+static inline SumsetNodeKind input_data_start_kind(const InputData* input_data)
+{
+    if (!input_data->bounded)
+        return SUMSET_NODE_DEAD;
+    return sumset_node_kind(&input_data->a_start, &input_data->b_start);
+}
 
 // Initialize all structures in the InputData structure with multisets containing given elements.
 // Useful for debugging, when we don't want to provide input on stdin.
@@ -48,7 +68,13 @@ void solution_init(Solution* s);
 // We compare the final sumset with input_data->a_start and input_data->b_start by value.
 // This allows to determine which multiset was built from A_0 and which from B_0.
 // (We can't have A_0^Σ = B_0^Σ unless A_0,B_0 have non-trivial common subset sums or A_0=B_0).
-void solution_build(Solution* s, InputData* input_data, const Sumset* a, const Sumset* b);
+void solution_build(Solution* s, const InputData* input_data, const Sumset* a, const Sumset* b);
 
 // Prints the solution to stdout as required.
 void solution_print(const Solution* s);
+
+// Prints the verdict of a search for a solution with ∑A ≥ target (see Options) to stdout, one line of key=value pairs:
+//   target=T verdict=reached nodes=N pruned=P    followed by the witness, the solution `s` (see solution_print)
+//   target=T verdict=refuted nodes=N pruned=P    the whole search found none, N nodes expanded and P pruned prove it
+//   target=T verdict=unknown nodes=N pruned=P    the search was stopped (see Options.deadline) before either
+void target_print(int target, const Solution* s, bool complete, unsigned long nodes, unsigned long pruned);
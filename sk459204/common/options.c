@@ -0,0 +1,226 @@
+#include "common/options.h"
+#include "common/err.h"
+#include "common/estimate.h"
+
+#include <getopt.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    OPTION_BOUND = 256,
+    OPTION_ENGINE,
+    OPTION_CURSORS,
+    OPTION_STATS,
+    OPTION_CACHE,
+    OPTION_CACHE_MAX_SUM,
+    OPTION_CHECKPOINT,
+    OPTION_CHECKPOINT_INTERVAL,
+    OPTION_RESUME,
+    OPTION_SHARD,
+    OPTION_CONNECT,
+    OPTION_ESTIMATE,
+    OPTION_PROGRESS,
+    OPTION_DEADLINE,
+    OPTION_TARGET,
+    OPTION_SWEEP,
+};
+
+#define DEFAULT_CHECKPOINT_INTERVAL 600
+#define DEFAULT_PROGRESS_INTERVAL 10
+
+
+static _Noreturn void usage(const char* program)
+{
+    fatal("usage: %s [-b | --branch-and-bound] [--bound=NAME] [--engine=frames|pool] [--cursors=K] [--stats]\n"
+          "\t[--cache=MB [--cache-max-sum=SUM]] [--checkpoint=FILE [--checkpoint-interval=SECONDS] [--resume]]\n"
+          "\t[--shard=K/N | --connect=SOCKET] [--estimate[=PROBES]] [--progress[=SECONDS]] [--deadline=SECONDS]\n"
+          "\t[--target=T] [--sweep] < input\n"
+          "\tbounds: %s",
+        program, bound_function_names);
+}
+
+// Parse a non-negative decimal number (on bad usage, print a usage message and quit).
+static unsigned long parse_number(const char* program, const char* arg)
+{
+    char* end;
+    unsigned long number = strtoul(arg, &end, 10);
+    if (*arg == '\0' || *arg == '-' || *end != '\0')
+        usage(program);
+    return number;
+}
+
+void options_init(Options* options)
+{
+    options->bound = NULL;
+    options->engine = ENGINE_FRAMES;
+    options->cursors = 1;
+    options->stats = false;
+    options->cache_bytes = 0;
+    options->cache_max_sum = 0;
+    options->checkpoint_path = NULL;
+    options->checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL;
+    options->resume = false;
+    options->shard = 0;
+    options->shards = 0;
+    options->connect_path = NULL;
+    options->estimate_probes = 0;
+    options->progress_interval = 0;
+    options->deadline = 0;
+    options->target = 0;
+    options->sweep = false;
+    options->larger_first = false;
+}
+
+void options_parse(Options* options, int argc, char* argv[])
+{
+    static const struct option long_options[] = {
+        { "branch-and-bound", no_argument, NULL, 'b' },
+        { "bound", required_argument, NULL, OPTION_BOUND },
+        { "engine", required_argument, NULL, OPTION_ENGINE },
+        { "cursors", required_argument, NULL, OPTION_CURSORS },
+        { "stats", no_argument, NULL, OPTION_STATS },
+        { "cache", required_argument, NULL, OPTION_CACHE },
+        { "cache-max-sum", required_argument, NULL, OPTION_CACHE_MAX_SUM },
+        { "checkpoint", required_argument, NULL, OPTION_CHECKPOINT },
+        { "checkpoint-interval", required_argument, NULL, OPTION_CHECKPOINT_INTERVAL },
+        { "resume", no_argument, NULL, OPTION_RESUME },
+        { "shard", required_argument, NULL, OPTION_SHARD },
+        { "connect", required_argument, NULL, OPTION_CONNECT },
+        { "estimate", optional_argument, NULL, OPTION_ESTIMATE },
+        { "progress", optional_argument, NULL, OPTION_PROGRESS },
+        { "deadline", required_argument, NULL, OPTION_DEADLINE },
+        { "target", required_argument, NULL, OPTION_TARGET },
+        { "sweep", no_argument, NULL, OPTION_SWEEP },
+        { NULL, 0, NULL, 0 },
+    };
+
+    options_init(options);
+    const char* stats = getenv("SUMSET_STATS");
+    options->stats = stats != NULL && *stats != '\0' && strcmp(stats, "0") != 0;
+
+    int c;
+    while ((c = getopt_long(argc, argv, "b", long_options, NULL)) != -1) {
+        switch (c) {
+        case 'b':
+            options->bound = bound_pigeonhole;
+            break;
+        case OPTION_BOUND:
+            options->bound = bound_function_by_name(optarg);
+            if (options->bound == NULL)
+                usage(argv[0]);
+            break;
+        case OPTION_ENGINE:
+            if (strcmp(optarg, "frames") == 0)
+                options->engine = ENGINE_FRAMES;
+            else if (strcmp(optarg, "pool") == 0)
+                options->engine = ENGINE_POOL;
+            else
+                usage(argv[0]);
+            break;
+        case OPTION_CURSORS:
+            options->cursors = parse_number(argv[0], optarg);
+            if (options->cursors < 1 || options->cursors > OPTIONS_MAX_CURSORS)
+                usage(argv[0]);
+            break;
+        case OPTION_STATS:
+            options->stats = true;
+            break;
+        case OPTION_CACHE:
+            options->cache_bytes = (size_t)parse_number(argv[0], optarg) << 20;
+            break;
+        case OPTION_CACHE_MAX_SUM: {
+            unsigned long max_sum = parse_number(argv[0], optarg);
+            if (max_sum == 0 || max_sum > MAX_D * MAX_D)
+                usage(argv[0]);
+            options->cache_max_sum = max_sum;
+            break;
+        }
+        case OPTION_CHECKPOINT:
+            options->checkpoint_path = optarg;
+            break;
+        case OPTION_CHECKPOINT_INTERVAL:
+            options->checkpoint_interval = parse_number(argv[0], optarg);
+            if (options->checkpoint_interval == 0)
+                usage(argv[0]);
+            break;
+        case OPTION_RESUME:
+            options->resume = true;
+            break;
+        case OPTION_SHARD: {
+            char end;
+            if (sscanf(optarg, "%d/%d%c", &options->shard, &options->shards, &end) != 2 || options->shard < 1
+                || options->shard > options->shards)
+                usage(argv[0]);
+            break;
+        }
+        case OPTION_CONNECT:
+            options->connect_path = optarg;
+            break;
+        case OPTION_ESTIMATE:
+            options->estimate_probes = optarg ? parse_number(argv[0], optarg) : ESTIMATE_DEFAULT_PROBES;
+            if (options->estimate_probes <= 0)
+                usage(argv[0]);
+            break;
+        case OPTION_PROGRESS:
+            options->progress_interval = optarg ? parse_number(argv[0], optarg) : DEFAULT_PROGRESS_INTERVAL;
+            if (options->progress_interval == 0)
+                usage(argv[0]);
+            break;
+        case OPTION_DEADLINE:
+            options->deadline = parse_number(argv[0], optarg);
+            if (options->deadline == 0)
+                usage(argv[0]);
+            break;
+        case OPTION_TARGET: {
+            unsigned long target = parse_number(argv[0], optarg);
+            if (target == 0 || target > MAX_D * MAX_D)
+                usage(argv[0]);
+            options->target = target;
+            break;
+        }
+        case OPTION_SWEEP:
+            options->sweep = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc || (options->resume && options->checkpoint_path == NULL))
+        usage(argv[0]);
+    // A worker's part of the search is up to its coordinator.
+    if (options->connect_path && (options->checkpoint_path || options->shards || options->estimate_probes
+            || options->progress_interval || options->deadline || options->target))
+        usage(argv[0]);
+    // Each shard would only have a verdict on its own part, and merge would take the best solution of a shard
+    // stopped by a deadline for the one of its whole part.
+    if ((options->target || options->deadline) && options->shards)
+        usage(argv[0]);
+    // A sweep keeps a solution per d', which checkpoints, shards and coordinators don't carry, and the cache
+    // can't tell nodes with different largest elements apart.
+    if (options->sweep && (options->cache_bytes || options->checkpoint_path || options->shards
+            || options->connect_path || options->deadline || options->target))
+        usage(argv[0]);
+    if (options->cache_max_sum && options->cache_bytes == 0)
+        usage(argv[0]);
+    if (options->cursors > 1 && options->engine == ENGINE_POOL)
+        usage(argv[0]);
+    if (options->target && options->bound == NULL)
+        options->bound = bound_pigeonhole;
+    options->larger_first = options->deadline || options->target;
+    if (options->progress_interval && options->estimate_probes == 0)
+        options->estimate_probes = ESTIMATE_DEFAULT_PROBES;
+}
+
+void options_check_implementation(const Options* options, Implementation implementation, const char* program)
+{
+    // The reference implementation runs the whole search in one go.
+    if (implementation == IMPLEMENTATION_REFERENCE && (options->checkpoint_path || options->shards
+            || options->estimate_probes || options->deadline
+            || options->target || options->cursors > 1))
+        usage(program);
+    // Only the parallel implementation can be a worker (see remote.h).
+    if (implementation != IMPLEMENTATION_PARALLEL && options->connect_path)
+        usage(program);
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "common/bound.h"
+#include "common/width.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define OPTIONS_MAX_CURSORS 64
+
+// Search engines of the nonrecursive implementation.
+typedef enum Engine {
+    ENGINE_FRAMES, // explicit DFS frames, children built one at a time (the default)
+    ENGINE_POOL, // stack of all open children, pooled sumsets with reference counts
+} Engine;
+
+// Implementations, for the options each of them supports (see options_check_implementation).
+typedef enum Implementation {
+    IMPLEMENTATION_REFERENCE,
+    IMPLEMENTATION_NONRECURSIVE,
+    IMPLEMENTATION_PARALLEL,
+} Implementation;
+
+// Command-line options shared by all implementations. The task input is still read from stdin.
+typedef struct Options {
+    // Branch-and-bound: skip every node whose bound doesn't exceed the best sum found so far.
+    // NULL if the whole tree should be explored.
+    BoundFunction bound;
+
+    // Which engine the nonrecursive implementation uses (ignored by the others).
+    Engine engine;
+
+    // DFS cursors the frames engine and every parallel worker advance in turn, one node each, prefetching the next
+    // cursor's node while expanding the current one's (1 by default, not with the pool engine).
+    int cursors;
+
+    // Print per-worker search counters to stderr at exit (see stats.h).
+    bool stats;
+
+    // Memory budget of the transposition cache (see cache.h), 0 if there's no cache.
+    size_t cache_bytes;
+
+    // Only nodes whose larger sum is at most this are looked up in the cache, 0 for CACHE_DEFAULT_MAX_SUM(d).
+    int cache_max_sum;
+
+    // Where the nonrecursive and parallel implementations periodically save the search (see checkpoint.h),
+    // NULL if they don't.
+    const char* checkpoint_path;
+
+    // Seconds between checkpoints.
+    unsigned long checkpoint_interval;
+
+    // Resume the search from the checkpoint at checkpoint_path, if there is one.
+    bool resume;
+
+    // Only explore part `shard` (from 1) of `shards` parts of the search (see shard.h), 0 shards for all of it.
+    int shard;
+    int shards;
+
+    // Explore branches handed out by the coordinator listening at this socket instead of the whole search
+    // (see remote.h), NULL if not a worker. Only the parallel implementation can be a worker.
+    const char* connect_path;
+
+    // Random walks spent on estimating the size of the search (see estimate.h), 0 if it isn't estimated.
+    int estimate_probes;
+
+    // Seconds between progress reports against the estimate, 0 if there are none. Without them,
+    // the nonrecursive and parallel implementations only print the estimate and quit.
+    unsigned long progress_interval;
+
+    // Seconds the nonrecursive and parallel implementations may run for, 0 if there's no deadline. Past it, the
+    // search stops where it is, and its best solution so far is printed.
+    unsigned long deadline;
+
+    // Verification (nonrecursive and parallel implementations): only look for a solution with ∑A ≥ target, pruning
+    // every node whose bound is below it, and stop at the first one found (see target_print), 0 to find the best
+    // solution. A checkpoint of such a search must be resumed with the same target.
+    int target;
+
+    // Report α(d', A₀, B₀) with a witness for every d' from max(3, largest element of A₀ ∪ B₀) up to d, from one
+    // search for d (see sweep.h).
+    bool sweep;
+
+    // Visit children from the largest element added rather than the smallest, which reaches large sums much
+    // earlier. Set with a deadline or a target, the default order is kept otherwise (it decides which of equally
+    // good solutions is printed).
+    bool larger_first;
+} Options;
+
+// Set the defaults: the whole tree explored, no cache, nothing printed but the solution.
+#define options_init WIDTH_NAME(options_init)
+void options_init(Options* options);
+
+// Parse argv into options (on bad usage, print a usage message and quit).
+//
+//   -b, --branch-and-bound    prune with the default bound (pigeonhole)
+//   --bound=NAME              prune with the named bound (see bound.h)
+//   --engine=frames|pool      nonrecursive search engine
+//   --cursors=K               interleave K DFS cursors (1 ≤ K ≤ 64, frames engine and parallel implementation only)
+//   --cache=MB                skip nodes already visited through another path, using at most MB megabytes
+//   --cache-max-sum=SUM       only look up nodes whose larger sum is at most SUM (d²/20 by default, needs --cache)
+//   --stats                   print search counters (also enabled by a non-empty SUMSET_STATS other than 0)
+//   --checkpoint=FILE         save the search to FILE every --checkpoint-interval=SECONDS (600 by default, not with
+//                             the reference implementation)
+//   --resume                  resume the search from the checkpoint FILE, if it exists
+//   --shard=K/N               only explore shard K of N (1 ≤ K ≤ N, not with the reference implementation)
+//   --connect=SOCKET          work for the coordinator at SOCKET (parallel implementation only, not with
+//                             --checkpoint, --shard, --estimate, --progress, --deadline nor --target)
+//   --estimate[=PROBES]       print the estimated size of the search (from 10000 random walks by default) and quit
+//                             (not with the reference implementation, nor is --progress)
+//   --progress[=SECONDS]      estimate the search, then run it reporting progress and ETA every SECONDS (10 by default)
+//   --deadline=SECONDS        stop after SECONDS and print the best solution so far (not with the reference
+//                             implementation, --shard nor --connect)
+//   --target=T                only decide whether there's a solution with sum at least T, pruning with the bound
+//                             (pigeonhole by default, not with the reference implementation, --shard nor --connect)
+//   --sweep                   report α for every d' up to d from one search (not with --cache, --checkpoint,
+//                             --shard, --connect, --deadline nor --target)
+#define options_parse WIDTH_NAME(options_parse)
+void options_parse(Options* options, int argc, char* argv[]);
+
+// Quit with the usage message if `options` has one the implementation doesn't support, rather than ignore it.
+#define options_check_implementation WIDTH_NAME(options_check_implementation)
+void options_check_implementation(const Options* options, Implementation implementation, const char* program);
@@ -0,0 +1,216 @@
+#include "common/remote.h"
+#include "common/checkpoint.h"
+#include "common/err.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REMOTE_CONNECT_ATTEMPTS 100
+#define REMOTE_CONNECT_RETRY_NS 100000000 // 100 attempts 0.1s apart: a worker waits up to 10s for its coordinator
+#define REMOTE_RECEIVE_BYTES 65536 // room made for each read
+
+static const char* const message_names[] = {
+    [MESSAGE_HELLO] = "hello",
+    [MESSAGE_BOUND] = "bound",
+    [MESSAGE_BRANCH] = "branch",
+    [MESSAGE_DONE] = "done",
+    [MESSAGE_SPLIT] = "split",
+    [MESSAGE_QUIT] = "quit",
+};
+
+static void socket_address(struct sockaddr_un* address, const char* path)
+{
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path))
+        fatal("socket path %s is too long", path);
+    strcpy(address->sun_path, path);
+}
+
+int remote_listen(const char* path)
+{
+    struct sockaddr_un address;
+    socket_address(&address, path);
+
+    // A socket left behind by an earlier coordinator would make bind fail.
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        ASSERT_SYS_OK(unlink(path));
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_SYS_OK(fd);
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+        syserr("cannot listen at %s", path);
+    ASSERT_SYS_OK(listen(fd, SOMAXCONN));
+    return fd;
+}
+
+void remote_connect(Remote* remote, const char* path)
+{
+    struct sockaddr_un address;
+    socket_address(&address, path);
+
+    for (int attempt = 1;; attempt++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        ASSERT_SYS_OK(fd);
+        if (connect(fd, (struct sockaddr*)&address, sizeof(address)) == 0) {
+            remote_init(remote, fd);
+            return;
+        }
+        if ((errno != ENOENT && errno != ECONNREFUSED) || attempt == REMOTE_CONNECT_ATTEMPTS)
+            syserr("cannot connect to %s", path);
+        ASSERT_SYS_OK(close(fd));
+        struct timespec retry = { 0, REMOTE_CONNECT_RETRY_NS };
+        nanosleep(&retry, NULL);
+    }
+}
+
+void remote_init(Remote* remote, int fd)
+{
+    remote->fd = fd;
+    remote->buffer = NULL;
+    remote->length = 0;
+    remote->size = 0;
+}
+
+void remote_close(Remote* remote)
+{
+    ASSERT_SYS_OK(close(remote->fd));
+    free(remote->buffer);
+}
+
+bool remote_receive(Remote* remote)
+{
+    if (remote->size - remote->length < REMOTE_RECEIVE_BYTES) {
+        remote->size = remote->length + REMOTE_RECEIVE_BYTES;
+        remote->buffer = realloc(remote->buffer, remote->size);
+        if (remote->buffer == NULL)
+            fatal("cannot allocate %zu bytes for messages", remote->size);
+    }
+
+    ssize_t received;
+    do {
+        received = read(remote->fd, remote->buffer + remote->length, remote->size - remote->length);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0 && errno == ECONNRESET)
+        return false;
+    ASSERT_SYS_OK(received);
+    remote->length += received;
+    return received > 0;
+}
+
+static _Noreturn void malformed(const char* line)
+{
+    fatal("malformed message: %s", line);
+}
+
+bool remote_next(Remote* remote, const InputData* input_data, Message* message)
+{
+    char* end = memchr(remote->buffer, '\n', remote->length);
+    if (end == NULL)
+        return false;
+    *end = '\0';
+    char* line = remote->buffer;
+    size_t length = end - line;
+    if (length == 0)
+        malformed(line);
+
+    FILE* file = fmemopen(line, length, "r");
+    if (file == NULL)
+        syserr("cannot parse a message");
+    char name[16];
+    if (fscanf(file, "%15s", name) != 1)
+        malformed(line);
+    int kind = 0;
+    while (kind <= MESSAGE_QUIT && strcmp(name, message_names[kind]) != 0)
+        kind++;
+    message->kind = kind;
+
+    bool ok = true;
+    switch (kind) {
+    case MESSAGE_HELLO:
+        ok = checkpoint_read_input(file, input_data, &message->same_input);
+        break;
+    case MESSAGE_BOUND:
+        ok = fscanf(file, "%d", &message->sum) == 1;
+        break;
+    case MESSAGE_BRANCH:
+        ok = checkpoint_read_branch(file, input_data->d, &message->branch);
+        break;
+    case MESSAGE_DONE:
+        ok = checkpoint_read_solution(file, input_data->d, &message->solution)
+            && checkpoint_read_stats(file, &message->stats);
+        break;
+    case MESSAGE_SPLIT:
+    case MESSAGE_QUIT:
+        break;
+    default:
+        ok = false;
+    }
+    // The rest of a hello with another input isn't read (its multisets may not even fit).
+    char extra[2];
+    if (!ok || (!(kind == MESSAGE_HELLO && !message->same_input) && fscanf(file, "%1s", extra) != EOF))
+        malformed(line);
+    fclose(file);
+
+    remote->length -= length + 1;
+    memmove(remote->buffer, end + 1, remote->length);
+    return true;
+}
+
+bool remote_send(Remote* remote, const InputData* input_data, const Message* message)
+{
+    char* text;
+    size_t length;
+    FILE* file = open_memstream(&text, &length);
+    if (file == NULL)
+        syserr("cannot write a message");
+    fprintf(file, "%s", message_names[message->kind]);
+    switch (message->kind) {
+    case MESSAGE_HELLO:
+        fprintf(file, " ");
+        checkpoint_write_input(file, input_data);
+        break;
+    case MESSAGE_BOUND:
+        fprintf(file, " %d", message->sum);
+        break;
+    case MESSAGE_BRANCH:
+        fprintf(file, " ");
+        checkpoint_write_branch(file, &message->branch);
+        break;
+    case MESSAGE_DONE:
+        fprintf(file, " ");
+        checkpoint_write_solution(file, &message->solution);
+        fprintf(file, " ");
+        checkpoint_write_stats(file, &message->stats);
+        break;
+    case MESSAGE_SPLIT:
+    case MESSAGE_QUIT:
+        break;
+    }
+    fprintf(file, "\n");
+    if (fclose(file) != 0)
+        syserr("cannot write a message");
+
+    bool sent = true;
+    for (size_t done = 0; done < length;) {
+        ssize_t written = send(remote->fd, text + done, length - done, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0 && (errno == EPIPE || errno == ECONNRESET)) {
+            sent = false;
+            break;
+        }
+        ASSERT_SYS_OK(written);
+        done += written;
+    }
+    free(text);
+    return sent;
+}
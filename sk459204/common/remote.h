@@ -0,0 +1,81 @@
+#pragma once
+#include "common/branch.h"
+#include "common/io.h"
+#include "common/stats.h"
+#include "common/width.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Width-specific functions (see width.h).
+#define remote_listen WIDTH_NAME(remote_listen)
+#define remote_connect WIDTH_NAME(remote_connect)
+#define remote_init WIDTH_NAME(remote_init)
+#define remote_close WIDTH_NAME(remote_close)
+#define remote_receive WIDTH_NAME(remote_receive)
+#define remote_next WIDTH_NAME(remote_next)
+#define remote_send WIDTH_NAME(remote_send)
+
+// Coordinator/worker mode: a coordinator process owns the frontier of the search and hands its branches out one
+// at a time to worker processes (the parallel solver with --connect), over a Unix-domain socket on the same machine.
+// A worker explores its branch with all its threads and asks for another when it's done. When a worker is idle and
+// the frontier is empty, the coordinator asks a busy worker to split: the worker stops its threads where they are
+// and sends back everything they haven't explored. Best sums are passed on to every worker, for pruning.
+//
+// Messages are lines of text:
+//   worker → coordinator   hello <input>             first message, the input the worker read
+//                          bound <sum>               the worker found a solution with this sum
+//                          branch <branch>           unexplored part of the worker's branch, when asked to split
+//                          done <solution> <stats>   the worker finished (or split) its branch and wants another
+//   coordinator → worker   hello <input>             answer to hello, the input the coordinator read
+//                          branch <branch>           explore this branch
+//                          bound <sum>               a solution with this sum was found, prune with it
+//                          split                     stop and send the unexplored part of the current branch back
+//                                                    (ignored by an idle worker, it crossed its done message)
+//                          quit                      the search is over
+// where <input>, <branch>, <solution> and <stats> are as in checkpoints (see checkpoint.h).
+typedef enum MessageKind {
+    MESSAGE_HELLO,
+    MESSAGE_BOUND,
+    MESSAGE_BRANCH,
+    MESSAGE_DONE,
+    MESSAGE_SPLIT,
+    MESSAGE_QUIT,
+} MessageKind;
+
+typedef struct Message {
+    MessageKind kind;
+    bool same_input; // hello: whether the sender read the input the receiver did
+    int sum; // bound
+    Branch branch; // branch
+    Solution solution; // done: the best solution found in the branch
+    Stats stats; // done: counters of all the worker's threads for the branch
+} Message;
+
+// One end of a connection, with the bytes received and not parsed yet.
+typedef struct Remote {
+    int fd;
+    char* buffer;
+    size_t length;
+    size_t size;
+} Remote;
+
+// Create a socket listening at `path` (replacing a stale socket, but no other kind of file) and return it.
+int remote_listen(const char* path);
+
+// Connect to the coordinator listening at `path`, retrying for a while if it doesn't listen yet (quits if it never does).
+void remote_connect(Remote* remote, const char* path);
+
+// Wrap a connected socket.
+void remote_init(Remote* remote, int fd);
+
+void remote_close(Remote* remote);
+
+// Read what has arrived on the socket (waits if nothing has). Returns false once the other end is gone.
+bool remote_receive(Remote* remote);
+
+// Take the next complete message received, returns false if there isn't one yet (quits if it's malformed).
+bool remote_next(Remote* remote, const InputData* input_data, Message* message);
+
+// Send a message (only the fields of its kind are used). Returns false if the other end is gone.
+bool remote_send(Remote* remote, const InputData* input_data, const Message* message);
@@ -0,0 +1,171 @@
+#include "common/shard.h"
+#include "common/bound.h"
+#include "common/err.h"
+#include "common/estimate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct ShardNode {
+    Branch branch; // always a whole node
+    int bound; // pigeonhole bound of the node
+    double weight; // estimated size of its subtree
+} ShardNode;
+
+typedef struct ShardNodes {
+    ShardNode* nodes;
+    int count;
+    int size;
+} ShardNodes;
+
+static void add_node(ShardNodes* nodes, const InputData* input_data, const Sumset* a, const Sumset* b)
+{
+    if (nodes->count == nodes->size) {
+        nodes->size = nodes->size ? 2 * nodes->size : 64;
+        nodes->nodes = realloc(nodes->nodes, nodes->size * sizeof(ShardNode));
+        if (nodes->nodes == NULL)
+            fatal("cannot allocate %d shard nodes", nodes->size);
+    }
+    ShardNode* node = &nodes->nodes[nodes->count++];
+    branch_init(&node->branch, input_data, a, b, NULL);
+    node->bound = bound_pigeonhole(a, b, input_data->d);
+    node->weight = estimate_node(input_data, a, b, NULL, false, NULL, 0, SHARD_ESTIMATE_PROBES);
+}
+
+// Replace the open node (a, b) with its open children, recording its terminal children in `best`.
+// Children of a symmetric node get a copy of b with last raised (see sumset_node_is_symmetric).
+static void expand(ShardNodes* nodes, const InputData* input_data, Solution* best, const Sumset* a,
+    const Sumset* b, bool symmetric)
+{
+    if (a->sum > b->sum) {
+        const Sumset* tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    SumsetChildren children;
+    sumset_expand(a, b, input_data->d, &children);
+    Sumset child, b_from_i;
+    while (!element_set_is_empty(&children.terminal)) {
+        sumset_add(&child, a, element_set_pop_min(&children.terminal));
+        if (child.sum > best->sum)
+            solution_build(best, input_data, &child, b);
+    }
+    while (!element_set_is_empty(&children.open)) {
+        int i = element_set_pop_min(&children.open);
+        sumset_add(&child, a, i);
+        if (symmetric) {
+            sumset_copy(&b_from_i, b);
+            b_from_i.last = i;
+            add_node(nodes, input_data, &child, &b_from_i);
+        } else {
+            add_node(nodes, input_data, &child, b);
+        }
+    }
+}
+
+static int compare_by_weight(const void* x, const void* y)
+{
+    const ShardNode* a = *(const ShardNode* const*)x;
+    const ShardNode* b = *(const ShardNode* const*)y;
+    if (a->weight != b->weight)
+        return a->weight > b->weight ? -1 : 1;
+    return a < b ? -1 : (a > b);
+}
+
+static int compare_by_bound(const void* x, const void* y)
+{
+    const ShardNode* a = *(const ShardNode* const*)x;
+    const ShardNode* b = *(const ShardNode* const*)y;
+    if (a->bound != b->bound)
+        return a->bound > b->bound ? -1 : 1;
+    return a < b ? -1 : (a > b);
+}
+
+// Expand the top of the tree into at least `count` open nodes (if it's that large), recording terminal nodes in `best`.
+// Returns them sorted with `compare` (freed by the caller, like nodes->nodes).
+static ShardNode** split_top(ShardNodes* nodes, const InputData* input_data, Solution* best, int count,
+    int (*compare)(const void*, const void*))
+{
+    const Sumset* a_start = &input_data->a_start;
+    const Sumset* b_start = &input_data->b_start;
+    switch (input_data_start_kind(input_data)) {
+    case SUMSET_NODE_OPEN:
+        expand(nodes, input_data, best, a_start, b_start, sumset_node_is_symmetric(a_start, b_start));
+        break;
+    case SUMSET_NODE_TERMINAL:
+        solution_build(best, input_data, a_start, b_start);
+        break;
+    case SUMSET_NODE_DEAD:
+        break;
+    }
+
+    // Split the heaviest node (the first one on ties) until there are enough of them.
+    while (nodes->count > 0 && nodes->count < count) {
+        int heaviest = 0;
+        for (int i = 1; i < nodes->count; i++)
+            if (nodes->nodes[i].weight > nodes->nodes[heaviest].weight)
+                heaviest = i;
+        Branch branch = nodes->nodes[heaviest].branch;
+        nodes->nodes[heaviest] = nodes->nodes[--nodes->count];
+
+        Sumset* a_chain = malloc((branch_side_size(&branch.a) + 2) * sizeof(Sumset));
+        Sumset* b_chain = malloc((branch_side_size(&branch.b) + 2) * sizeof(Sumset));
+        if (a_chain == NULL || b_chain == NULL)
+            fatal("cannot allocate a branch");
+        const Sumset* a = branch_side_build(&branch.a, input_data, a_chain);
+        const Sumset* b = branch_side_build(&branch.b, input_data, b_chain);
+        expand(nodes, input_data, best, a, b, false);
+        free(a_chain);
+        free(b_chain);
+    }
+
+    ShardNode** order = malloc((nodes->count + 1) * sizeof(ShardNode*));
+    if (order == NULL)
+        fatal("cannot allocate shards");
+    for (int i = 0; i < nodes->count; i++)
+        order[i] = &nodes->nodes[i];
+    qsort(order, nodes->count, sizeof(ShardNode*), compare);
+    return order;
+}
+
+void shard_split(Checkpoint* checkpoint, const InputData* input_data, int k, int n)
+{
+    ShardNodes nodes = { NULL, 0, 0 };
+    ShardNode** order = split_top(&nodes, input_data, &checkpoint->best, SHARD_BRANCHES_PER_SHARD * n, compare_by_weight);
+
+    // Deal the nodes out heaviest first, each to the shard with the smallest load.
+    double* loads = calloc(n, sizeof(double));
+    if (loads == NULL)
+        fatal("cannot allocate shards");
+    for (int i = 0; i < nodes.count; i++) {
+        int lightest = 0;
+        for (int s = 1; s < n; s++)
+            if (loads[s] < loads[lightest])
+                lightest = s;
+        loads[lightest] += order[i]->weight + 1;
+        if (lightest == k - 1)
+            checkpoint_add(checkpoint, &order[i]->branch);
+    }
+
+    free(loads);
+    free(order);
+    free(nodes.nodes);
+}
+
+void shard_frontier(Checkpoint* checkpoint, const InputData* input_data, int count)
+{
+    ShardNodes nodes = { NULL, 0, 0 };
+    ShardNode** order = split_top(&nodes, input_data, &checkpoint->best, count, compare_by_bound);
+    for (int i = 0; i < nodes.count; i++)
+        checkpoint_add(checkpoint, &order[i]->branch);
+    free(order);
+    free(nodes.nodes);
+}
+
+void shard_print_header(int k, int n, const InputData* input_data)
+{
+    printf("shard %d/%d input ", k, n);
+    checkpoint_write_input(stdout, input_data);
+    printf("\n");
+}
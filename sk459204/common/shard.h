@@ -0,0 +1,34 @@
+#pragma once
+#include "common/checkpoint.h"
+#include "common/io.h"
+#include "common/width.h"
+
+// Width-specific functions (see width.h).
+#define shard_split WIDTH_NAME(shard_split)
+#define shard_frontier WIDTH_NAME(shard_frontier)
+#define shard_print_header WIDTH_NAME(shard_print_header)
+
+// Sharding splits one search across processes (or hosts) that share nothing: every shard enumerates the same
+// top of the tree, deterministically, and explores only its part of it. The best of the shards' solutions
+// is the solution of the whole search (see the merge tool).
+//
+// The top of the tree is expanded from the start node, always splitting the heaviest open node, until there
+// are at least SHARD_BRANCHES_PER_SHARD branches per shard. The branches are then dealt out heaviest first,
+// each to the shard with the smallest total weight so far. The weight of a node is the size of its subtree,
+// estimated from SHARD_ESTIMATE_PROBES random walks (see estimate.h).
+#define SHARD_BRANCHES_PER_SHARD 16
+#define SHARD_ESTIMATE_PROBES 64
+
+// Set `checkpoint` (initialized and empty) to the branches of shard k of n (1 ≤ k ≤ n), and its best solution to
+// the best terminal node met while splitting, so that the shard runs like a search resumed from a checkpoint.
+void shard_split(Checkpoint* checkpoint, const InputData* input_data, int k, int n);
+
+// Print the line "shard K/N input D A_0 B_0" (the input as in a checkpoint) that precedes the output of shard k
+// of n, so that merge can tell that all the shards it's given are parts of the same search.
+void shard_print_header(int k, int n, const InputData* input_data);
+
+// Set `checkpoint` (initialized and empty) to the whole search split the same way into at least `count` branches
+// (if the tree is that large), and its best solution to the best terminal node met while splitting. Branches come
+// with the highest bound first: exploring the most promising ones first finds good solutions early, which
+// prunes more of the others under branch-and-bound.
+void shard_frontier(Checkpoint* checkpoint, const InputData* input_data, int count);
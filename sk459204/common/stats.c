@@ -0,0 +1,68 @@
+#include "common/stats.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+void stats_init(Stats* stats)
+{
+    memset(stats, 0, sizeof(Stats));
+}
+
+uint64_t stats_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+void stats_merge(Stats* total, const Stats* stats)
+{
+    total->nodes_expanded += stats->nodes_expanded;
+    total->children_generated += stats->children_generated;
+    total->children_rejected += stats->children_rejected;
+    total->terminal_checks += stats->terminal_checks;
+    total->pruned += stats->pruned;
+    total->cache_hits += stats->cache_hits;
+    total->cache_misses += stats->cache_misses;
+    total->pool_allocs += stats->pool_allocs;
+    total->branches_given += stats->branches_given;
+    total->branches_taken += stats->branches_taken;
+    total->idle_ns += stats->idle_ns;
+    total->lock_wait_ns += stats->lock_wait_ns;
+    if (stats->run_ns > total->run_ns)
+        total->run_ns = stats->run_ns;
+}
+
+void stats_add_run(Stats* total, const Stats* earlier)
+{
+    uint64_t run_ns = total->run_ns + earlier->run_ns;
+    stats_merge(total, earlier);
+    total->run_ns = run_ns;
+}
+
+static void stats_print_line(const char* worker, const Stats* stats)
+{
+    double run_s = stats->run_ns / 1e9;
+    fprintf(stderr,
+        "stats: worker=%s nodes_expanded=%lu children_generated=%lu children_rejected=%lu"
+        " terminal_checks=%lu pruned=%lu cache_hits=%lu cache_misses=%lu pool_allocs=%lu"
+        " branches_given=%lu branches_taken=%lu idle_s=%.6f lock_wait_s=%.6f run_s=%.6f nodes_per_s=%.0f\n",
+        worker, stats->nodes_expanded, stats->children_generated, stats->children_rejected,
+        stats->terminal_checks, stats->pruned, stats->cache_hits, stats->cache_misses, stats->pool_allocs,
+        stats->branches_given, stats->branches_taken, stats->idle_ns / 1e9, stats->lock_wait_ns / 1e9, run_s,
+        run_s > 0 ? stats->nodes_expanded / run_s : 0.0);
+}
+
+void stats_print(const Stats* stats, int workers)
+{
+    Stats total;
+    stats_init(&total);
+    for (int i = 0; i < workers; ++i) {
+        char worker[16];
+        snprintf(worker, sizeof(worker), "%d", i);
+        stats_print_line(worker, &stats[i]);
+        stats_merge(&total, &stats[i]);
+    }
+    stats_print_line("total", &total);
+}
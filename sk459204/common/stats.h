@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+// Search counters. Every worker updates its own copy (no sharing, no atomics), copies are merged at exit.
+typedef struct Stats {
+    unsigned long nodes_expanded; // open nodes whose children were classified
+    unsigned long children_generated; // open and terminal children built
+    unsigned long children_rejected; // candidate elements whose child turned out dead
+    unsigned long terminal_checks; // terminal children compared against the best solution
+    unsigned long pruned; // open nodes skipped by branch-and-bound
+    unsigned long cache_hits; // open nodes skipped because the cache had them
+    unsigned long cache_misses; // open nodes looked up in the cache and recorded there
+    unsigned long pool_allocs; // sumsets taken from a pool or slab
+    unsigned long branches_given; // branches handed over to the scheduler
+    unsigned long branches_taken; // branches popped or stolen from the scheduler
+    uint64_t idle_ns; // time spent looking for (or waiting for) a branch
+    uint64_t lock_wait_ns; // time spent acquiring mutexes
+    uint64_t run_ns; // time spent in the search
+} Stats;
+
+void stats_init(Stats* stats);
+
+// Monotonic clock, in nanoseconds.
+uint64_t stats_now_ns(void);
+
+// Add the counters of `stats` to `total`. Workers run side by side, so run_ns is the maximum.
+void stats_merge(Stats* total, const Stats* stats);
+
+// Add the counters of an earlier run of the same search (see checkpoint.h) to `total`.
+// Like stats_merge, except that the runs came one after another, so run_ns adds up.
+void stats_add_run(Stats* total, const Stats* earlier);
+
+// Print one line per worker and one line for their total to stderr, e.g.
+//   stats: worker=0 nodes_expanded=... run_s=0.512 nodes_per_s=...
+//   stats: worker=total nodes_expanded=... run_s=0.512 nodes_per_s=...
+// Each line is "stats:" followed by space-separated key=value pairs, always in the same order.
+void stats_print(const Stats* stats, int workers);
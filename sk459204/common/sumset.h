@@ -13,8 +13,10 @@
 static pthread_mutex_t _stdout_mutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
-// Maximum number ever added to multisets.
-#define MAX_D 50
+// Maximum number ever added to multisets, set by the build for each compiled width (see width.h).
+#ifndef MAX_D
+#error "MAX_D must be defined (see width.h)"
+#endif
 
 // Details of the sumset implementation.
 typedef uint64_t Word;
@@ -30,34 +32,82 @@ typedef struct Sumset {
     // Sum of all elements (this is also the largest value in the sumset, but we cache it here).
     int sum;
 
+    // Number of elements in A, counted with multiplicities.
+    int size;
+
     // Pointer to sumset this one was derived from (see sumset_add), allows recovering A (with solution_build()).
     const struct Sumset* prev;
 
     // The i-th bit is set iff i is in the sumset. Accessing this directly is forbidden for this homework.
+    // Only the first sumset_live_words(sum) words are kept up to date (bits above `sum` in them are zero),
+    // the remaining words may contain garbage.
     Word sumset[MAX_WORDS];
 } Sumset;
 
+// Number of leading words of Sumset.sumset that can be non-zero for a sumset with the given sum.
+static inline int sumset_live_words(int sum)
+{
+    return sum / BITS_PER_WORD + 1;
+}
+
 // Initialize a sumset to represent an empty multiset A (with last=1 and prev=NULL), A^Σ={0}.
 static inline void sumset_init(Sumset* s)
 {
-    for (int i = 0; i < MAX_WORDS; ++i)
-        s->sumset[i] = 0;
     s->sumset[0] = 1;
     s->last = 1;
     s->sum = 0;
+    s->size = 0;
     s->prev = NULL;
 }
 
 // Return whether the sumset A^Σ contains the value x (that is, x is a sum of some subset of A).
 static inline bool does_sumset_contain(const Sumset* a, int x)
 {
-    if (x >= MAX_BITS)
+    if (x > a->sum)
         return false;
     return a->sumset[x / BITS_PER_WORD] & (((Word)1) << (x % BITS_PER_WORD));
 }
 
 static inline void _sumset_add(Sumset* result, const Sumset* a, int x);
 
+// Set `*result` to a copy of `*a` (including last and prev), copying only the live words.
+static inline void sumset_copy(Sumset* result, const Sumset* a)
+{
+    result->last = a->last;
+    result->sum = a->sum;
+    result->size = a->size;
+    result->prev = a->prev;
+    int words = sumset_live_words(a->sum);
+    for (int i = 0; i < words; ++i)
+        result->sumset[i] = a->sumset[i];
+}
+
+#define SUMSET_CACHE_LINE_BYTES 64
+
+// Hint the CPU to bring the live words of `s` into cache, for a sumset that's read soon but not right away.
+// Reads s->sum, so the first cache line of `s` should already be on its way.
+static inline void sumset_prefetch(const Sumset* s)
+{
+    const char* line = (const char*)s->sumset;
+    const char* end = (const char*)&s->sumset[sumset_live_words(s->sum)];
+    for (; line < end; line += SUMSET_CACHE_LINE_BYTES)
+        __builtin_prefetch(line);
+}
+
+// Return whether A^Σ = B^Σ (ignoring last, size and prev), comparing only the live words.
+static inline bool sumset_eq(const Sumset* a, const Sumset* b)
+{
+    if (a == b)
+        return true;
+    if (a->sum != b->sum)
+        return false;
+    int words = sumset_live_words(a->sum);
+    for (int i = 0; i < words; i++)
+        if (a->sumset[i] != b->sumset[i])
+            return false;
+    return true;
+}
+
 // Set `*result` to represent (A ∪ {x})^Σ, where `a` represents A^Σ, and `x` is an element added to A.
 //
 // Also sets result->last=x and result->prev=a (keeping track of added elements, for recovery in with solution_build()).
@@ -75,16 +125,106 @@ static inline void sumset_add(Sumset* result, const Sumset* a, int x)
     _sumset_add(result, a, x);
 }
 
+// Word-level kernels behind the sumset operations, working on plain Word arrays.
+// The scalar versions below are always available; SIMD versions (sumset_kernels.c)
+// are selected at startup based on CPUID.
+typedef struct SumsetKernels {
+    const char* name;
+
+    // result[0, words) = (a | a << x)[0, words), where only a[0, a_words) can be non-zero.
+    // Words are written from the highest, so `result` can be `a`.
+    void (*add)(Word* result, const Word* a, int a_words, int words, int x);
+
+    // Return the number of bits set in (a & b)[0, words).
+    size_t (*intersection_size)(const Word* a, const Word* b, int words);
+
+    // Return whether (a & b)[0, words) is exactly {0}.
+    bool (*is_intersection_trivial)(const Word* a, const Word* b, int words);
+
+    // Same as add, and return the number of bits set in (result & b)[0, min(words, b_words)), in the same pass.
+    size_t (*add_and_intersect)(Word* result, const Word* a, int a_words, int words, int x, const Word* b, int b_words);
+} SumsetKernels;
+
+// Kernels used by the sumset operations on long sumsets (scalar until selected otherwise).
+extern SumsetKernels sumset_kernels;
+
+// Below this many words, the inlined scalar loops are faster than calling through sumset_kernels.
+#define SUMSET_KERNELS_MIN_WORDS 8
+
+// Select kernels by name ("scalar", "avx2", "avx512"). Return false if the CPU doesn't support them. At startup,
+// the best supported kernels are selected, unless the SUMSET_KERNELS environment variable names others. That they
+// agree with the scalar ones bit for bit is checked by test/kernels.c.
+bool sumset_kernels_select(const char* name);
+
+// The i-th word of `a`, or 0 if it's outside of the live words [0, words).
+static inline Word _sumset_word(const Word* a, int words, int i)
+{
+    return (0 <= i && i < words) ? a[i] : 0;
+}
+
+// The i-th word of (a | a << x), where x = s * BITS_PER_WORD + r.
+static inline Word _sumset_add_word(const Word* a, int a_words, int s, int r, int i)
+{
+    Word w = _sumset_word(a, a_words, i) | (_sumset_word(a, a_words, i - s) << r);
+    if (r != 0)
+        w |= _sumset_word(a, a_words, i - s - 1) >> (BITS_PER_WORD - r);
+    return w;
+}
+
+static inline void _sumset_add_scalar(Word* result, const Word* a, int a_words, int words, int x)
+{
+    int s = x / BITS_PER_WORD;
+    int r = x % BITS_PER_WORD;
+    for (int i = words - 1; i >= 0; --i)
+        result[i] = _sumset_add_word(a, a_words, s, r, i);
+}
+
+static inline size_t _sumset_intersection_size_scalar(const Word* a, const Word* b, int words)
+{
+    size_t c = 0;
+    for (int i = 0; i < words; ++i)
+        c += __builtin_popcountll(a[i] & b[i]);
+    return c;
+}
+
+static inline bool _sumset_is_intersection_trivial_scalar(const Word* a, const Word* b, int words)
+{
+    if ((a[0] & b[0]) != 1)
+        return false;
+    for (int i = 1; i < words; ++i)
+        if (a[i] & b[i])
+            return false;
+    return true;
+}
+
+static inline size_t _sumset_add_and_intersect_scalar(
+    Word* result, const Word* a, int a_words, int words, int x, const Word* b, int b_words)
+{
+    int s = x / BITS_PER_WORD;
+    int r = x % BITS_PER_WORD;
+    size_t c = 0;
+    for (int i = words - 1; i >= 0; --i) {
+        Word w = _sumset_add_word(a, a_words, s, r, i);
+        result[i] = w;
+        if (i < b_words)
+            c += __builtin_popcountll(w & b[i]);
+    }
+    return c;
+}
+
 // Same as `sumset_add`, but leaves `result->prev` and `result->last` unchanged (they must already be initialized).
 // (This is only useful for setting up the initial forced multisets A_0, B_0 in input_data_init/input_data_read).
 static inline void _sumset_add(Sumset* result, const Sumset* a, int x) {
+    int a_words = sumset_live_words(a->sum);
+
     result->sum = a->sum + x;
+    result->size = a->size + 1;
     assert(result->sum < MAX_BITS);
 
 #ifdef LOG_SUMSET
     pthread_mutex_lock(&_stdout_mutex);
     printf("sumset_add: %d %d; ", x, a->sum);
-    for (int i = 0; i <= MAX_BITS; ++i)
+    for (int i = 0; i <= a->sum; ++i)
         if (does_sumset_contain(a, i))
             printf(" %d", i);
     printf("\n");
@@ -93,16 +233,13 @@ static inline void _sumset_add(Sumset* result, const Sumset* a, int x) {
 
     // The following does:
     //   result->sumset =  a->sumset | (a->sumset << x);
-    // over multiple words.
+    // over the live words only.
 
-    int s = x / BITS_PER_WORD;
-    int r = x % BITS_PER_WORD;
-
-    for (int i = MAX_WORDS - 1; i > s; --i)
-        result->sumset[i] = a->sumset[i] | (a->sumset[i - s] << r) | (a->sumset[i - s - 1] >> (BITS_PER_WORD - r));
-    result->sumset[s] = a->sumset[s] | a->sumset[0] << r;
-    for (int i = s - 1; i >= 0; --i)
-        result->sumset[i] = a->sumset[i];
+    int words = sumset_live_words(result->sum);
+    if (words < SUMSET_KERNELS_MIN_WORDS)
+        _sumset_add_scalar(result->sumset, a->sumset, a_words, words, x);
+    else
+        sumset_kernels.add(result->sumset, a->sumset, a_words, words, x);
 }
 
 
@@ -111,20 +248,216 @@ static inline void _sumset_add(Sumset* result, const Sumset* a, int x) {
 // If ΣA=ΣB and this returns 2, then the intersection is {0, ΣA}.
 static inline size_t get_sumset_intersection_size(const Sumset* a, const Sumset* b)
 {
-    size_t c = 0;
-    for (int i = 0; i < MAX_WORDS; ++i)
-        c += __builtin_popcountll(a->sumset[i] & b->sumset[i]);
-    return c;
+    int words = sumset_live_words(a->sum < b->sum ? a->sum : b->sum);
+    if (words < SUMSET_KERNELS_MIN_WORDS)
+        return _sumset_intersection_size_scalar(a->sumset, b->sumset, words);
+    return sumset_kernels.intersection_size(a->sumset, b->sumset, words);
 }
 
 // Return whether the intersection of the sumsets A^Σ and B^Σ is trivial (contains only 0).
 // This is equivalent to get_sumset_intersection_size(a, b) == 1, but faster.
 static inline bool is_sumset_intersection_trivial(const Sumset* a, const Sumset* b)
 {
-    if ((a->sumset[0] & b->sumset[0]) != 1)
-        return false;
-    for (int i = 1; i < MAX_WORDS; ++i)
-        if (a->sumset[i] & b->sumset[i])
+    int words = sumset_live_words(a->sum < b->sum ? a->sum : b->sum);
+    if (words < SUMSET_KERNELS_MIN_WORDS)
+        return _sumset_is_intersection_trivial_scalar(a->sumset, b->sumset, words);
+    return sumset_kernels.is_intersection_trivial(a->sumset, b->sumset, words);
+}
+
+// Set `*result` to represent (A ∪ {x})^Σ exactly like sumset_add(result, a, x), and return |(A ∪ {x})^Σ ∩ B^Σ|,
+// computed in the same pass over the words. `result` can't be `b`.
+static inline size_t sumset_add_and_intersect(Sumset* result, const Sumset* a, int x, const Sumset* b)
+{
+    assert(x >= a->last);
+    assert(x <= MAX_D);
+    assert(result != b);
+
+    int a_words = sumset_live_words(a->sum);
+    int b_words = sumset_live_words(b->sum);
+
+    result->prev = a;
+    result->last = x;
+    result->sum = a->sum + x;
+    result->size = a->size + 1;
+    assert(result->sum < MAX_BITS);
+
+    int words = sumset_live_words(result->sum);
+    if (words < SUMSET_KERNELS_MIN_WORDS)
+        return _sumset_add_and_intersect_scalar(result->sumset, a->sumset, a_words, words, x, b->sumset, b_words);
+    return sumset_kernels.add_and_intersect(result->sumset, a->sumset, a_words, words, x, b->sumset, b_words);
+}
+
+// What the search does with a node (a, b).
+typedef enum SumsetNodeKind {
+    SUMSET_NODE_DEAD, // A^Σ ∩ B^Σ has a non-zero element other than ∑A = ∑B, no extension of (A, B) is undisputed.
+    SUMSET_NODE_OPEN, // A^Σ ∩ B^Σ = {0}, the node can be expanded.
+    SUMSET_NODE_TERMINAL, // ∑A = ∑B and A^Σ ∩ B^Σ = {0, ∑A}, (A, B) is an undisputed pair.
+} SumsetNodeKind;
+
+// Classify the node (a, b).
+static inline SumsetNodeKind sumset_node_kind(const Sumset* a, const Sumset* b)
+{
+    if (is_sumset_intersection_trivial(a, b)) // s(a) ∩ s(b) = {0}.
+        return SUMSET_NODE_OPEN;
+    if ((a->sum == b->sum) && (get_sumset_intersection_size(a, b) == 2)) // s(a) ∩ s(b) = {0, ∑b}.
+        return SUMSET_NODE_TERMINAL;
+    return SUMSET_NODE_DEAD;
+}
+
+// Set `*result` to the child of the open node (a, b) obtained by adding x to A (like sumset_add), and classify the node (result, b).
+// Since A^Σ ∩ B^Σ = {0} is already known, this takes a single pass over the words of a and b.
+static inline SumsetNodeKind sumset_add_child(Sumset* result, const Sumset* a, int x, const Sumset* b)
+{
+    size_t intersection_size = sumset_add_and_intersect(result, a, x, b);
+    if (intersection_size == 1)
+        return SUMSET_NODE_OPEN;
+    if ((result->sum == b->sum) && (intersection_size == 2))
+        return SUMSET_NODE_TERMINAL;
+    return SUMSET_NODE_DEAD;
+}
+
+// Whether the subtrees of (a, b) and (b, a) are the same up to swapping the sides (A^Σ = B^Σ, same last).
+// Then every pair is found twice, so it's enough to expand each child (a ∪ {x}, b) with b's last raised to x:
+// only pairs where the smallest element added to a is at most every element added to b are visited.
+static inline bool sumset_node_is_symmetric(const Sumset* a, const Sumset* b)
+{
+    return a->last == b->last && sumset_eq(a, b);
+}
+
+// A set of elements from {0, ..., MAX_D}, one bit per element.
+#define ELEMENT_SET_WORDS ((MAX_D + BITS_PER_WORD) / BITS_PER_WORD)
+typedef struct ElementSet {
+    Word bits[ELEMENT_SET_WORDS];
+} ElementSet;
+
+static inline bool element_set_is_empty(const ElementSet* s)
+{
+    for (int i = 0; i < ELEMENT_SET_WORDS; ++i)
+        if (s->bits[i])
+            return false;
+    return true;
+}
+
+static inline bool element_set_contains(const ElementSet* s, int x)
+{
+    return s->bits[x / BITS_PER_WORD] & (((Word)1) << (x % BITS_PER_WORD));
+}
+
+// Remove and return the smallest element of a non-empty set.
+static inline int element_set_pop_min(ElementSet* s)
+{
+    for (int i = 0;; ++i) {
+        if (s->bits[i]) {
+            int bit = __builtin_ctzll(s->bits[i]);
+            s->bits[i] &= s->bits[i] - 1;
+            return i * BITS_PER_WORD + bit;
+        }
+    }
+}
+
+// Remove and return the largest element of a non-empty set.
+static inline int element_set_pop_max(ElementSet* s)
+{
+    for (int i = ELEMENT_SET_WORDS - 1;; --i) {
+        if (s->bits[i]) {
+            int bit = BITS_PER_WORD - 1 - __builtin_clzll(s->bits[i]);
+            s->bits[i] &= ~(((Word)1) << bit);
+            return i * BITS_PER_WORD + bit;
+        }
+    }
+}
+
+static inline int element_set_size(const ElementSet* s)
+{
+    int size = 0;
+    for (int i = 0; i < ELEMENT_SET_WORDS; ++i)
+        size += __builtin_popcountll(s->bits[i]);
+    return size;
+}
+
+// Keep the `keep` smallest elements in s and move the rest to `rest`.
+static inline void element_set_split(ElementSet* s, int keep, ElementSet* rest)
+{
+    for (int i = 0; i < ELEMENT_SET_WORDS; ++i) {
+        Word w = s->bits[i];
+        for (; w && keep > 0; --keep)
+            w &= w - 1;
+        rest->bits[i] = w;
+        s->bits[i] &= ~w;
+    }
+}
+
+// Children of an open node (a, b), by the element x added to A.
+typedef struct SumsetChildren {
+    ElementSet open; // (A ∪ {x}, B) is open.
+    ElementSet terminal; // (A ∪ {x}, B) is terminal.
+    ElementSet all; // open ∪ terminal, the children worth building.
+    int rejected; // Number of candidates x whose child is dead.
+} SumsetChildren;
+
+// Whether (A^Σ + x) ∩ B^Σ has no element other than `ignore` (pass -1 to ignore nothing).
+// Low words are tested first, since that's where most children collide.
+static inline bool _sumset_shift_misses(const Sumset* a, int x, const Sumset* b, int ignore)
+{
+    int a_words = sumset_live_words(a->sum);
+    int b_words = sumset_live_words(b->sum);
+    int words = sumset_live_words(a->sum + x);
+    if (words > b_words)
+        words = b_words;
+
+    int s = x / BITS_PER_WORD;
+    int r = x % BITS_PER_WORD;
+    for (int i = s; i < words; ++i) {
+        Word w = _sumset_word(a->sumset, a_words, i - s) << r;
+        if (r != 0)
+            w |= _sumset_word(a->sumset, a_words, i - s - 1) >> (BITS_PER_WORD - r);
+        w &= b->sumset[i];
+        if (w && ignore >= 0 && i == ignore / BITS_PER_WORD)
+            w &= ~(((Word)1) << (ignore % BITS_PER_WORD));
+        if (w)
             return false;
+    }
     return true;
-}
\ No newline at end of file
+}
+
+// Classify all children of the open node (a, b) at once, without building them.
+// The candidates x ∈ [a->last, d] \ B^Σ come from the low words of b in one go, each candidate
+// is then tested by sliding A^Σ over B^Σ by x, stopping at the first collision (most children die immediately).
+// Build the surviving children with sumset_add.
+static inline void sumset_expand(const Sumset* a, const Sumset* b, int d, SumsetChildren* children)
+{
+    assert(d <= MAX_D);
+
+    int b_words = sumset_live_words(b->sum);
+    ElementSet candidates;
+    for (int i = 0; i < ELEMENT_SET_WORDS; ++i) {
+        Word allowed = (i < b_words) ? ~b->sumset[i] : ~(Word)0;
+        int low = a->last - i * BITS_PER_WORD; // allowed elements in this word are in [low, high]
+        int high = d - i * BITS_PER_WORD;
+        if (high < 0 || low >= (int)BITS_PER_WORD)
+            allowed = 0;
+        if (low > 0 && low < (int)BITS_PER_WORD)
+            allowed &= ~((((Word)1) << low) - 1);
+        if (high >= 0 && high < (int)BITS_PER_WORD - 1)
+            allowed &= (((Word)1) << (high + 1)) - 1;
+        candidates.bits[i] = allowed;
+        children->open.bits[i] = 0;
+        children->terminal.bits[i] = 0;
+    }
+
+    int candidates_count = element_set_size(&candidates);
+    while (!element_set_is_empty(&candidates)) {
+        int x = element_set_pop_min(&candidates);
+        Word bit = ((Word)1) << (x % BITS_PER_WORD);
+        if (a->sum + x == b->sum) {
+            if (_sumset_shift_misses(a, x, b, b->sum))
+                children->terminal.bits[x / BITS_PER_WORD] |= bit;
+        } else if (_sumset_shift_misses(a, x, b, -1)) {
+            children->open.bits[x / BITS_PER_WORD] |= bit;
+        }
+    }
+
+    for (int i = 0; i < ELEMENT_SET_WORDS; ++i)
+        children->all.bits[i] = children->open.bits[i] | children->terminal.bits[i];
+    children->rejected = candidates_count - element_set_size(&children->all);
+}
@@ -0,0 +1,290 @@
+#include "common/sumset.h"
+#include "common/err.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SUMSET_KERNELS_X86 1
+#endif
+
+static const SumsetKernels scalar_kernels = {
+    "scalar",
+    _sumset_add_scalar,
+    _sumset_intersection_size_scalar,
+    _sumset_is_intersection_trivial_scalar,
+    _sumset_add_and_intersect_scalar,
+};
+
+SumsetKernels sumset_kernels = scalar_kernels;
+
+#ifdef SUMSET_KERNELS_X86
+
+// AVX2: 4 words per vector.
+//
+// The shift by x = s * 64 + r reads each output block from two unaligned windows of `a`,
+// shifted back by s and s + 1 words, and funnels them together with a left shift by r
+// and a right shift by 64 - r (a vector shift by 64 gives zeros, so r = 0 needs no special case).
+// Words whose windows would leave the live words of `a` are done with the scalar code.
+
+__attribute__((target("avx2"))) static void sumset_add_avx2(Word* result, const Word* a, int a_words, int words, int x)
+{
+    int s = x / BITS_PER_WORD;
+    int r = x % BITS_PER_WORD;
+    __m128i left = _mm_cvtsi32_si128(r);
+    __m128i right = _mm_cvtsi32_si128(BITS_PER_WORD - r);
+
+    int i = words - 1;
+    for (; i >= a_words; --i)
+        result[i] = _sumset_add_word(a, a_words, s, r, i);
+    // Block [i - 3, i] needs words down to i - 3 - s - 1 >= 0.
+    for (; i - 4 - s >= 0; i -= 4) {
+        __m256i w = _mm256_loadu_si256((const __m256i*)(a + i - 3));
+        __m256i low = _mm256_loadu_si256((const __m256i*)(a + i - 3 - s));
+        __m256i carry = _mm256_loadu_si256((const __m256i*)(a + i - 4 - s));
+        w = _mm256_or_si256(w, _mm256_or_si256(_mm256_sll_epi64(low, left), _mm256_srl_epi64(carry, right)));
+        _mm256_storeu_si256((__m256i*)(result + i - 3), w);
+    }
+    for (; i >= 0; --i)
+        result[i] = _sumset_add_word(a, a_words, s, r, i);
+}
+
+// Per-64-bit-lane popcount with a nibble lookup table (there's no VPOPCNTQ in AVX2).
+__attribute__((target("avx2"))) static inline __m256i popcount_epi64_avx2(__m256i v)
+{
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i low = _mm256_and_si256(v, low_mask);
+    __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2"))) static size_t sumset_intersection_size_avx2(const Word* a, const Word* b, int words)
+{
+    __m256i total = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        total = _mm256_add_epi64(total, popcount_epi64_avx2(_mm256_and_si256(va, vb)));
+    }
+    size_t c = _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1)
+        + _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+    for (; i < words; ++i)
+        c += __builtin_popcountll(a[i] & b[i]);
+    return c;
+}
+
+__attribute__((target("avx2"))) static bool sumset_is_intersection_trivial_avx2(const Word* a, const Word* b, int words)
+{
+    if ((a[0] & b[0]) != 1)
+        return false;
+    int i = 1;
+    for (; i + 4 <= words; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        if (!_mm256_testz_si256(va, vb))
+            return false;
+    }
+    for (; i < words; ++i)
+        if (a[i] & b[i])
+            return false;
+    return true;
+}
+
+__attribute__((target("avx2"))) static size_t sumset_add_and_intersect_avx2(
+    Word* result, const Word* a, int a_words, int words, int x, const Word* b, int b_words)
+{
+    int s = x / BITS_PER_WORD;
+    int r = x % BITS_PER_WORD;
+    __m128i left = _mm_cvtsi32_si128(r);
+    __m128i right = _mm_cvtsi32_si128(BITS_PER_WORD - r);
+    __m256i total = _mm256_setzero_si256();
+    size_t c = 0;
+
+    int i = words - 1;
+    for (; i >= a_words; --i) {
+        result[i] = _sumset_add_word(a, a_words, s, r, i);
+        if (i < b_words)
+            c += __builtin_popcountll(result[i] & b[i]);
+    }
+    for (; i - 4 - s >= 0; i -= 4) {
+        __m256i w = _mm256_loadu_si256((const __m256i*)(a + i - 3));
+        __m256i low = _mm256_loadu_si256((const __m256i*)(a + i - 3 - s));
+        __m256i carry = _mm256_loadu_si256((const __m256i*)(a + i - 4 - s));
+        w = _mm256_or_si256(w, _mm256_or_si256(_mm256_sll_epi64(low, left), _mm256_srl_epi64(carry, right)));
+        _mm256_storeu_si256((__m256i*)(result + i - 3), w);
+        if (i < b_words) {
+            __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i - 3));
+            total = _mm256_add_epi64(total, popcount_epi64_avx2(_mm256_and_si256(w, vb)));
+        } else {
+            for (int j = i - 3; j < b_words; ++j)
+                c += __builtin_popcountll(result[j] & b[j]);
+        }
+    }
+    for (; i >= 0; --i) {
+        result[i] = _sumset_add_word(a, a_words, s, r, i);
+        if (i < b_words)
+            c += __builtin_popcountll(result[i] & b[i]);
+    }
+    return c + _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1)
+        + _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+}
+
+// AVX-512F: the same, 8 words per vector.
+
+__attribute__((target("avx512f"))) static void sumset_add_avx512(Word* result, const Word* a, int a_words, int words, int x)
+{
+    int s = x / BITS_PER_WORD;
+    int r = x % BITS_PER_WORD;
+    __m128i left = _mm_cvtsi32_si128(r);
+    __m128i right = _mm_cvtsi32_si128(BITS_PER_WORD - r);
+
+    int i = words - 1;
+    for (; i >= a_words; --i)
+        result[i] = _sumset_add_word(a, a_words, s, r, i);
+    // Block [i - 7, i] needs words down to i - 7 - s - 1 >= 0.
+    for (; i - 8 - s >= 0; i -= 8) {
+        __m512i w = _mm512_loadu_si512(a + i - 7);
+        __m512i low = _mm512_loadu_si512(a + i - 7 - s);
+        __m512i carry = _mm512_loadu_si512(a + i - 8 - s);
+        w = _mm512_or_si512(w, _mm512_or_si512(_mm512_sll_epi64(low, left), _mm512_srl_epi64(carry, right)));
+        _mm512_storeu_si512(result + i - 7, w);
+    }
+    for (; i >= 0; --i)
+        result[i] = _sumset_add_word(a, a_words, s, r, i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) static size_t sumset_intersection_size_avx512(
+    const Word* a, const Word* b, int words)
+{
+    __m512i total = _mm512_setzero_si512();
+    int i = 0;
+    for (; i + 8 <= words; i += 8) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_and_si512(va, vb)));
+    }
+    size_t c = _mm512_reduce_add_epi64(total);
+    for (; i < words; ++i)
+        c += __builtin_popcountll(a[i] & b[i]);
+    return c;
+}
+
+__attribute__((target("avx512f"))) static bool sumset_is_intersection_trivial_avx512(const Word* a, const Word* b, int words)
+{
+    if ((a[0] & b[0]) != 1)
+        return false;
+    int i = 1;
+    for (; i + 8 <= words; i += 8) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        if (_mm512_test_epi64_mask(va, vb))
+            return false;
+    }
+    for (; i < words; ++i)
+        if (a[i] & b[i])
+            return false;
+    return true;
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) static size_t sumset_add_and_intersect_avx512(
+    Word* result, const Word* a, int a_words, int words, int x, const Word* b, int b_words)
+{
+    int s = x / BITS_PER_WORD;
+    int r = x % BITS_PER_WORD;
+    __m128i left = _mm_cvtsi32_si128(r);
+    __m128i right = _mm_cvtsi32_si128(BITS_PER_WORD - r);
+    __m512i total = _mm512_setzero_si512();
+    size_t c = 0;
+
+    int i = words - 1;
+    for (; i >= a_words; --i) {
+        result[i] = _sumset_add_word(a, a_words, s, r, i);
+        if (i < b_words)
+            c += __builtin_popcountll(result[i] & b[i]);
+    }
+    for (; i - 8 - s >= 0; i -= 8) {
+        __m512i w = _mm512_loadu_si512(a + i - 7);
+        __m512i low = _mm512_loadu_si512(a + i - 7 - s);
+        __m512i carry = _mm512_loadu_si512(a + i - 8 - s);
+        w = _mm512_or_si512(w, _mm512_or_si512(_mm512_sll_epi64(low, left), _mm512_srl_epi64(carry, right)));
+        _mm512_storeu_si512(result + i - 7, w);
+        if (i < b_words) {
+            total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_and_si512(w, _mm512_loadu_si512(b + i - 7))));
+        } else {
+            for (int j = i - 7; j < b_words; ++j)
+                c += __builtin_popcountll(result[j] & b[j]);
+        }
+    }
+    for (; i >= 0; --i) {
+        result[i] = _sumset_add_word(a, a_words, s, r, i);
+        if (i < b_words)
+            c += __builtin_popcountll(result[i] & b[i]);
+    }
+    return c + _mm512_reduce_add_epi64(total);
+}
+
+#endif // SUMSET_KERNELS_X86
+
+// Fills kernels with the variant of the given name, if the CPU supports it.
+static bool sumset_kernels_find(SumsetKernels* kernels, const char* name)
+{
+    if (strcmp(name, "scalar") == 0) {
+        *kernels = scalar_kernels;
+        return true;
+    }
+#ifdef SUMSET_KERNELS_X86
+    __builtin_cpu_init();
+    if (strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        *kernels = (SumsetKernels) {
+            "avx2",
+            sumset_add_avx2,
+            sumset_intersection_size_avx2,
+            sumset_is_intersection_trivial_avx2,
+            sumset_add_and_intersect_avx2,
+        };
+        return true;
+    }
+    if (strcmp(name, "avx512") == 0 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2")) {
+        *kernels = (SumsetKernels) {
+            "avx512",
+            sumset_add_avx512,
+            // Without VPOPCNTQ, the nibble lookup on 256-bit vectors is the fastest popcount.
+            __builtin_cpu_supports("avx512vpopcntdq") ? sumset_intersection_size_avx512 : sumset_intersection_size_avx2,
+            sumset_is_intersection_trivial_avx512,
+            __builtin_cpu_supports("avx512vpopcntdq") ? sumset_add_and_intersect_avx512 : sumset_add_and_intersect_avx2,
+        };
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool sumset_kernels_select(const char* name)
+{
+    SumsetKernels kernels;
+    if (!sumset_kernels_find(&kernels, name))
+        return false;
+    sumset_kernels = kernels;
+    return true;
+}
+
+__attribute__((constructor)) static void sumset_kernels_init(void)
+{
+    const char* name = getenv("SUMSET_KERNELS");
+    if (name != NULL) {
+        if (!sumset_kernels_select(name))
+            fatal("SUMSET_KERNELS=%s is not supported on this CPU", name);
+        return;
+    }
+    if (!sumset_kernels_select("avx512"))
+        sumset_kernels_select("avx2");
+}
@@ -0,0 +1,60 @@
+#include "common/sweep.h"
+
+#include <stdio.h>
+
+void sweep_init(Sweep* sweep, const InputData* input_data)
+{
+    sweep->d = input_data->d;
+    sweep->largest_input = 0;
+    for (int x = 1; x <= input_data->d; x++) {
+        if (input_data->a_in.count[x] || input_data->b_in.count[x])
+            sweep->largest_input = x;
+    }
+    sweep->from = sweep->largest_input > 3 ? sweep->largest_input : 3;
+    for (int d = 0; d <= MAX_D; d++)
+        solution_init(&sweep->best[d]);
+}
+
+int sweep_record(Sweep* sweep, const InputData* input_data, const Sumset* a, const Sumset* b)
+{
+    int from = sweep_largest(sweep, a, b);
+    if (from < sweep->from)
+        from = sweep->from;
+    // Best sums don't decrease with d', so the pair beats none of them if it doesn't beat the first.
+    if (a->sum <= sweep->best[from].sum)
+        return 0;
+    Solution solution;
+    solution_build(&solution, input_data, a, b);
+    for (int d = from; d <= sweep->d && solution.sum > sweep->best[d].sum; d++)
+        sweep->best[d] = solution;
+    return from;
+}
+
+bool sweep_is_pruned(const Sweep* sweep, BoundFunction bound, const Sumset* a, const Sumset* b)
+{
+    int from = sweep_largest(sweep, a, b);
+    if (from < sweep->from)
+        from = sweep->from;
+    // Most nodes that aren't pruned have a bound above the best sum for d already.
+    for (int d = sweep->d; d >= from; d--) {
+        if (bound(a, b, d) > sweep->best[d].sum)
+            return false;
+    }
+    return true;
+}
+
+void sweep_merge(Sweep* total, const Sweep* other)
+{
+    for (int d = total->from; d <= total->d; d++) {
+        if (other->best[d].sum > total->best[d].sum)
+            total->best[d] = other->best[d];
+    }
+}
+
+void sweep_print(const Sweep* sweep)
+{
+    for (int d = sweep->from; d <= sweep->d; d++) {
+        printf("d=%d\n", d);
+        solution_print(&sweep->best[d]);
+    }
+}
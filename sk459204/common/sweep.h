@@ -0,0 +1,61 @@
+#pragma once
+#include "common/bound.h"
+#include "common/io.h"
+#include "common/sumset.h"
+#include "common/width.h"
+
+#include <stdbool.h>
+
+// Width-specific functions (see width.h).
+#define sweep_init WIDTH_NAME(sweep_init)
+#define sweep_record WIDTH_NAME(sweep_record)
+#define sweep_is_pruned WIDTH_NAME(sweep_is_pruned)
+#define sweep_merge WIDTH_NAME(sweep_merge)
+#define sweep_print WIDTH_NAME(sweep_print)
+
+// Sweeps (see Options.sweep): the search tree for d' is the part of the tree for d that only adds elements up to d',
+// so one search for d finds α(d', A₀, B₀) for every d' ≤ d, given the largest element of each pair it meets.
+// Elements are added to each side in non-decreasing order, so the largest element of a node is the last one
+// added to either side, or the largest element of A₀ ∪ B₀.
+//
+// A node can only be pruned if its bound for every d' whose tree has it doesn't exceed the best sum for that d'.
+// The transposition cache can't be used: a node reached through another path may have another largest element.
+typedef struct Sweep {
+    int from; // smallest d' reported, max(3, largest element of A₀ ∪ B₀)
+    int d;
+    int largest_input; // largest element of A₀ ∪ B₀, 0 if both are empty
+    Solution best[MAX_D + 1]; // best[d'] is the best solution found for d', for d' in [from, d]
+} Sweep;
+
+// The last element added to s, 0 if none was.
+static inline int sumset_last_added(const Sumset* s)
+{
+    return s->prev != NULL ? s->sum - s->prev->sum : 0;
+}
+
+// Largest element of the node (a, b), which is in the trees of all d' from there on.
+static inline int sweep_largest(const Sweep* sweep, const Sumset* a, const Sumset* b)
+{
+    int largest = sweep->largest_input;
+    if (sumset_last_added(a) > largest)
+        largest = sumset_last_added(a);
+    if (sumset_last_added(b) > largest)
+        largest = sumset_last_added(b);
+    return largest;
+}
+
+// Set up a sweep up to input_data->d, with no solutions yet.
+void sweep_init(Sweep* sweep, const InputData* input_data);
+
+// Record the undisputed pair (a, b) for every d' whose best solution it beats. Returns the smallest such d',
+// 0 if there is none.
+int sweep_record(Sweep* sweep, const InputData* input_data, const Sumset* a, const Sumset* b);
+
+// Whether the node (a, b) can't beat the best solution of any d' whose tree has it.
+bool sweep_is_pruned(const Sweep* sweep, BoundFunction bound, const Sumset* a, const Sumset* b);
+
+// Add the solutions of another part of the same sweep (ties go to `total`).
+void sweep_merge(Sweep* total, const Sweep* other);
+
+// Print the solution for every d' to stdout, each after a line "d=D'" (see solution_print).
+void sweep_print(const Sweep* sweep);
@@ -0,0 +1,80 @@
+#include "common/task.h"
+#include "common/err.h"
+#include "common/width.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int* read_elements(int count)
+{
+    int* elements = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (elements == NULL)
+        fatal("cannot allocate %d elements", count);
+    for (int i = 0; i < count; i++) {
+        if (scanf("%d", &elements[i]) != 1)
+            fatal("scanf");
+    }
+    return elements;
+}
+
+static bool elements_bounded(const int* elements, int count, int d)
+{
+    for (int i = 0; i < count; i++) {
+        if (elements[i] < 1 || elements[i] > d)
+            return false;
+    }
+    return true;
+}
+
+// Whether A_0 and B_0 are d-bounded.
+static bool task_input_bounded(const TaskInput* task)
+{
+    return elements_bounded(task->a, task->n, task->d) && elements_bounded(task->b, task->m, task->d);
+}
+
+void task_input_read(TaskInput* task, int max_d)
+{
+    if (scanf("%d%d%d%d", &task->t, &task->d, &task->n, &task->m) != 4)
+        fatal("scanf");
+    if (task->d < 3 || task->d > max_d)
+        fatal("d=%d is not supported, it must be in [3, %d]", task->d, max_d);
+    if (task->n < 0 || task->m < 0)
+        fatal("negative multiset size");
+    task->a = read_elements(task->n);
+    task->b = read_elements(task->m);
+    task->bounded = task_input_bounded(task);
+}
+
+static long elements_sum(const int* elements, int count)
+{
+    long sum = 0;
+    for (int i = 0; i < count; i++)
+        sum += elements[i];
+    return sum;
+}
+
+// A sumset of width w holds sums below w² (MAX_BITS). The search only makes the start sumsets A_0^Σ and B_0^Σ, and
+// children (A ∪ {x}, B) of open nodes (A^Σ ∩ B^Σ = {0}) with ∑A ≤ ∑B and x ≤ d. In an open node
+// min(∑A, ∑B) ≤ (d − 1)²: k numbers in [1, n] and n numbers in [1, k] always have non-empty sub-multisets with
+// equal sums, so |A| < max B or |B| < max A, and max A and max B aren't both d (d would be a common sum). So
+// children have sums at most (d − 1)² + d < d², and only A_0 and B_0 can need a width above d.
+int task_input_width(const TaskInput* task)
+{
+    long sum = 0;
+    if (task->bounded) {
+        long a_sum = elements_sum(task->a, task->n), b_sum = elements_sum(task->b, task->m);
+        sum = a_sum > b_sum ? a_sum : b_sum;
+    }
+#define RETURN_IF_FITS(width)                                   \
+    if (task->d <= width && sum < (long)width * width)          \
+        return width;
+    SUMSET_FOR_EACH_WIDTH(RETURN_IF_FITS)
+#undef RETURN_IF_FITS
+    return 0;
+}
+
+void task_input_destroy(TaskInput* task)
+{
+    free(task->a);
+    free(task->b);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdbool.h>
+
+// The task input (t, d, n, m, A_0, B_0) as read from stdin, before it's turned into sumsets.
+// Doesn't depend on the sumset width, so it can be read before a width is picked (see width.h).
+typedef struct TaskInput {
+    int t; // Number of threads that can be used.
+    int d; // Maximum element allowed in the multisets.
+    int n, m; // Sizes of A_0 and B_0.
+    int* a; // Elements of A_0.
+    int* b; // Elements of B_0.
+    bool bounded; // Whether all elements are in [1, d]. If not, α(d, A_0, B_0) = 0 (see input_data_load).
+} TaskInput;
+
+// Read the task input from stdin (quits on malformed input or 3 ≤ d ≤ max_d not holding).
+void task_input_read(TaskInput* task, int max_d);
+
+// The smallest sumset width (see width.h) that fits the task, or 0 if none does.
+int task_input_width(const TaskInput* task);
+
+void task_input_destroy(TaskInput* task);
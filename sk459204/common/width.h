@@ -0,0 +1,32 @@
+#pragma once
+
+// Sumsets are sized at compile time by MAX_D, the largest element they can hold. The sumset code and each solver
+// are compiled once per width (a value of MAX_D, see SUMSET_WIDTHS in CMakeLists.txt), and at startup the
+// smallest width that fits d and the sums of A_0 and B_0 is picked (see task_input_width). So small d gets small
+// nodes, and large d needs no rebuild.
+//
+// Functions whose types depend on the width get the width appended to their names (e.g. input_data_load_d32),
+// so that all widths can be linked into one executable. Headers rename them with WIDTH_NAME, and callers
+// compiled for a width keep using the plain names.
+
+#include "common/task.h"
+
+// Keep in sync with SUMSET_WIDTHS in CMakeLists.txt, from the smallest.
+#define SUMSET_FOR_EACH_WIDTH(X) X(16) X(32) X(64) X(128)
+#define SUMSET_MAX_WIDTH 128
+
+#define WIDTH_CONCAT_(name, width) name##_d##width
+#define WIDTH_CONCAT(name, width) WIDTH_CONCAT_(name, width)
+
+#ifdef MAX_D
+#define WIDTH_NAME(name) WIDTH_CONCAT(name, MAX_D)
+#endif
+
+// Entry point of each solver, compiled once per width: like main(), with the task input already read.
+#define SOLVER_MAIN_DECLARATION(width) int solver_main_d##width(int argc, char* argv[], const TaskInput* task);
+SUMSET_FOR_EACH_WIDTH(SOLVER_MAIN_DECLARATION)
+#undef SOLVER_MAIN_DECLARATION
+
+#ifdef MAX_D
+#define solver_main WIDTH_NAME(solver_main)
+#endif
@@ -0,0 +1,105 @@
+#include "common/worker_pool.h"
+#include "common/err.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+typedef struct QueuedTask {
+    WorkerTask task;
+    void* arg;
+    struct QueuedTask* next;
+} QueuedTask;
+
+struct WorkerPool {
+    pthread_t* threads;
+    int threads_count;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t queued; // signaled when a task is queued or the pool is destroyed
+    QueuedTask* head;
+    QueuedTask* tail;
+    bool closing;
+};
+
+static void* worker_pool_loop(void* arg)
+{
+    WorkerPool* pool = arg;
+    ASSERT_ZERO(pthread_mutex_lock(&pool->mutex));
+    while (true) {
+        while (pool->head == NULL && !pool->closing)
+            ASSERT_ZERO(pthread_cond_wait(&pool->queued, &pool->mutex));
+        if (pool->head == NULL)
+            break;
+        QueuedTask* queued = pool->head;
+        pool->head = queued->next;
+        if (pool->head == NULL)
+            pool->tail = NULL;
+        ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
+
+        queued->task(queued->arg);
+        free(queued);
+
+        ASSERT_ZERO(pthread_mutex_lock(&pool->mutex));
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
+    return NULL;
+}
+
+WorkerPool* worker_pool_create(int threads)
+{
+    WorkerPool* pool = malloc(sizeof(WorkerPool));
+    if (threads < 1)
+        threads = 1;
+    if (pool != NULL)
+        pool->threads = malloc(threads * sizeof(pthread_t));
+    if (pool == NULL || pool->threads == NULL)
+        fatal("cannot allocate a pool of %d threads", threads);
+    pool->threads_count = threads;
+    ASSERT_ZERO(pthread_mutex_init(&pool->mutex, NULL));
+    ASSERT_ZERO(pthread_cond_init(&pool->queued, NULL));
+    pool->head = NULL;
+    pool->tail = NULL;
+    pool->closing = false;
+    for (int i = 0; i < threads; i++)
+        ASSERT_ZERO(pthread_create(&pool->threads[i], NULL, worker_pool_loop, pool));
+    return pool;
+}
+
+int worker_pool_threads(const WorkerPool* pool)
+{
+    return pool->threads_count;
+}
+
+void worker_pool_submit(WorkerPool* pool, WorkerTask task, void* arg)
+{
+    QueuedTask* queued = malloc(sizeof(QueuedTask));
+    if (queued == NULL)
+        fatal("cannot allocate a task");
+    queued->task = task;
+    queued->arg = arg;
+    queued->next = NULL;
+
+    ASSERT_ZERO(pthread_mutex_lock(&pool->mutex));
+    if (pool->tail != NULL)
+        pool->tail->next = queued;
+    else
+        pool->head = queued;
+    pool->tail = queued;
+    ASSERT_ZERO(pthread_cond_signal(&pool->queued));
+    ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
+}
+
+void worker_pool_destroy(WorkerPool* pool)
+{
+    ASSERT_ZERO(pthread_mutex_lock(&pool->mutex));
+    pool->closing = true;
+    ASSERT_ZERO(pthread_cond_broadcast(&pool->queued));
+    ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
+    for (int i = 0; i < pool->threads_count; i++)
+        ASSERT_ZERO(pthread_join(pool->threads[i], NULL));
+    ASSERT_ZERO(pthread_mutex_destroy(&pool->mutex));
+    ASSERT_ZERO(pthread_cond_destroy(&pool->queued));
+    free(pool->threads);
+    free(pool);
+}
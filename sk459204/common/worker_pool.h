@@ -0,0 +1,19 @@
+#pragma once
+
+// A fixed set of threads running submitted tasks in the order they came, kept for as long as the pool lives. Searches
+// run their workers as tasks (see parallel/search.h), so running many of them, one after another or side by side,
+// doesn't pay for creating threads each time. Doesn't depend on the sumset width.
+typedef struct WorkerPool WorkerPool;
+
+typedef void (*WorkerTask)(void* arg);
+
+// Start a pool of `threads` threads (at least 1).
+WorkerPool* worker_pool_create(int threads);
+
+int worker_pool_threads(const WorkerPool* pool);
+
+// Queue task(arg) for the next idle thread. Never blocks.
+void worker_pool_submit(WorkerPool* pool, WorkerTask task, void* arg);
+
+// Run all tasks already submitted, then stop the threads and free the pool.
+void worker_pool_destroy(WorkerPool* pool);
@@ -0,0 +1,296 @@
+// Coordinator of a search spread over worker processes on the same machine (see common/remote.h).
+//
+// Usage: coordinator [--stats] SOCKET < input
+//
+// Listens at SOCKET for workers (parallel --connect=SOCKET, given the same input), hands the branches of the
+// search out to them, and prints the solution once all of them are explored. Workers may come and go at any
+// time: the branch of a worker that disconnects is handed out again.
+#include "common/checkpoint.h"
+#include "common/err.h"
+#include "common/io.h"
+#include "common/remote.h"
+#include "common/shard.h"
+#include "common/stats.h"
+
+#include <getopt.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define COORDINATOR_BRANCHES 64 // branches the top of the tree is split into before handing it out
+#define SPLIT_AFTER_NS 100000000 // a worker is only asked to split once it has been at its branch that long
+
+typedef struct Worker {
+    Remote remote;
+    bool connected; // false once it's gone (it stays in `workers` for --stats)
+    bool greeted; // said hello, with the same input
+    bool busy; // exploring `branch`
+    bool splitting; // asked to split, hasn't answered yet
+    uint64_t busy_since;
+    Branch branch; // handed out again if the worker disconnects before it's done
+    Stats stats; // counters of all the branches it's done
+} Worker;
+
+static InputData input_data;
+static Checkpoint frontier; // the best solution so far and the branches not handed out yet, the last one first
+static int best_sum; // best sum any worker reported (its solution comes with its done message)
+static Worker* workers;
+static int workers_count;
+static int workers_size;
+static unsigned long splits; // split requests answered
+static unsigned long branches_returned; // branches sent back by splitting workers
+
+static void worker_gone(Worker* worker)
+{
+    remote_close(&worker->remote);
+    worker->connected = false;
+    if (worker->busy) {
+        checkpoint_add(&frontier, &worker->branch);
+        worker->busy = false;
+    }
+}
+
+static void send_to(Worker* worker, const Message* message)
+{
+    if (!remote_send(&worker->remote, &input_data, message))
+        worker_gone(worker);
+}
+
+static void accept_worker(int listen_fd)
+{
+    int fd = accept(listen_fd, NULL, NULL);
+    ASSERT_SYS_OK(fd);
+    if (workers_count == workers_size) {
+        workers_size = workers_size ? 2 * workers_size : 16;
+        workers = realloc(workers, workers_size * sizeof(Worker));
+        if (workers == NULL)
+            fatal("cannot allocate %d workers", workers_size);
+    }
+    Worker* worker = &workers[workers_count++];
+    remote_init(&worker->remote, fd);
+    worker->connected = true;
+    worker->greeted = false;
+    worker->busy = false;
+    worker->splitting = false;
+    stats_init(&worker->stats);
+}
+
+// Passes a better sum on to every other worker, for pruning.
+static void raise_best_sum(int sum, const Worker* from)
+{
+    if (sum <= best_sum)
+        return;
+    best_sum = sum;
+    Message message = { .kind = MESSAGE_BOUND, .sum = sum };
+    for (int i = 0; i < workers_count; i++)
+        if (&workers[i] != from && workers[i].connected && workers[i].greeted)
+            send_to(&workers[i], &message);
+}
+
+static void handle(Worker* worker, const Message* message)
+{
+    switch (message->kind) {
+    case MESSAGE_HELLO: {
+        Message hello = { .kind = MESSAGE_HELLO };
+        send_to(worker, &hello);
+        if (!message->same_input) {
+            fprintf(stderr, "coordinator: a worker read a different input, sending it away\n");
+            if (worker->connected)
+                worker_gone(worker);
+            return;
+        }
+        worker->greeted = true;
+        if (best_sum > 0) {
+            Message bound = { .kind = MESSAGE_BOUND, .sum = best_sum };
+            send_to(worker, &bound);
+        }
+        return;
+    }
+    case MESSAGE_BOUND:
+        raise_best_sum(message->sum, worker);
+        return;
+    case MESSAGE_BRANCH:
+        if (worker->busy) {
+            checkpoint_add(&frontier, &message->branch);
+            branches_returned++;
+            return;
+        }
+        break;
+    case MESSAGE_DONE:
+        if (worker->busy) {
+            if (message->solution.sum > frontier.best.sum)
+                frontier.best = message->solution;
+            stats_add_run(&worker->stats, &message->stats);
+            splits += worker->splitting;
+            worker->busy = false;
+            worker->splitting = false;
+            raise_best_sum(message->solution.sum, worker);
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    fatal("unexpected message from a worker");
+}
+
+// Gives a branch to every idle worker, while there are any.
+static void hand_out(void)
+{
+    for (int i = 0; i < workers_count && frontier.branches_count > 0; i++) {
+        Worker* worker = &workers[i];
+        if (!worker->connected || !worker->greeted || worker->busy)
+            continue;
+        worker->branch = frontier.branches[--frontier.branches_count];
+        worker->busy = true;
+        worker->splitting = false;
+        worker->busy_since = stats_now_ns();
+        Message message = { .kind = MESSAGE_BRANCH, .branch = worker->branch };
+        send_to(worker, &message);
+    }
+}
+
+// If a worker is idle with nothing left to hand out, asks the worker that has been busy the longest to split
+// its branch (one split at a time). Returns how many milliseconds to wait before it can be asked, or -1.
+static int request_split(void)
+{
+    if (frontier.branches_count > 0)
+        return -1;
+    bool idle = false;
+    Worker* oldest = NULL;
+    for (int i = 0; i < workers_count; i++) {
+        Worker* worker = &workers[i];
+        if (!worker->connected || !worker->greeted)
+            continue;
+        if (!worker->busy)
+            idle = true;
+        else if (worker->splitting)
+            return -1;
+        else if (oldest == NULL || worker->busy_since < oldest->busy_since)
+            oldest = worker;
+    }
+    if (!idle || oldest == NULL)
+        return -1;
+
+    uint64_t busy_ns = stats_now_ns() - oldest->busy_since;
+    if (busy_ns < SPLIT_AFTER_NS)
+        return (SPLIT_AFTER_NS - busy_ns) / 1000000 + 1;
+    oldest->splitting = true;
+    Message message = { .kind = MESSAGE_SPLIT };
+    send_to(oldest, &message);
+    return -1;
+}
+
+static bool any_busy(void)
+{
+    for (int i = 0; i < workers_count; i++)
+        if (workers[i].connected && workers[i].busy)
+            return true;
+    return false;
+}
+
+static _Noreturn void usage(const char* program)
+{
+    fatal("usage: %s [--stats] SOCKET < input", program);
+}
+
+int solver_main(int argc, char* argv[], const TaskInput* task)
+{
+    static const struct option long_options[] = {
+        { "stats", no_argument, NULL, 's' },
+        { NULL, 0, NULL, 0 },
+    };
+    bool print_stats = false;
+    int c;
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        if (c != 's')
+            usage(argv[0]);
+        print_stats = true;
+    }
+    if (optind != argc - 1)
+        usage(argv[0]);
+    const char* socket_path = argv[optind];
+
+    input_data_load(&input_data, task);
+    checkpoint_init(&frontier);
+    shard_frontier(&frontier, &input_data, COORDINATOR_BRANCHES);
+    // Handed out from the end, the most promising branch first.
+    for (int i = 0, j = frontier.branches_count - 1; i < j; i++, j--) {
+        Branch branch = frontier.branches[i];
+        frontier.branches[i] = frontier.branches[j];
+        frontier.branches[j] = branch;
+    }
+    best_sum = frontier.best.sum;
+
+    int listen_fd = remote_listen(socket_path);
+    fprintf(stderr, "coordinator: %d branches, listening at %s\n", frontier.branches_count, socket_path);
+
+    struct pollfd* fds = NULL;
+    int* fds_workers = NULL;
+    while (true) {
+        hand_out();
+        if (frontier.branches_count == 0 && !any_busy())
+            break;
+        int timeout_ms = request_split();
+
+        fds = realloc(fds, (workers_count + 1) * sizeof(struct pollfd));
+        fds_workers = realloc(fds_workers, (workers_count + 1) * sizeof(int));
+        if (fds == NULL || fds_workers == NULL)
+            fatal("cannot allocate %d descriptors", workers_count + 1);
+        int fds_count = 0;
+        fds[fds_count++] = (struct pollfd) { .fd = listen_fd, .events = POLLIN };
+        for (int i = 0; i < workers_count; i++) {
+            if (workers[i].connected) {
+                fds_workers[fds_count] = i;
+                fds[fds_count++] = (struct pollfd) { .fd = workers[i].remote.fd, .events = POLLIN };
+            }
+        }
+        if (poll(fds, fds_count, timeout_ms) < 0)
+            syserr("poll");
+
+        for (int k = 1; k < fds_count; k++) {
+            if (fds[k].revents == 0)
+                continue;
+            Worker* worker = &workers[fds_workers[k]];
+            if (!remote_receive(&worker->remote)) {
+                worker_gone(worker);
+                continue;
+            }
+            Message message;
+            while (worker->connected && remote_next(&worker->remote, &input_data, &message))
+                handle(worker, &message);
+        }
+        // Last, since accepting may move the workers.
+        if (fds[0].revents)
+            accept_worker(listen_fd);
+    }
+
+    Message quit = { .kind = MESSAGE_QUIT };
+    for (int i = 0; i < workers_count; i++) {
+        if (workers[i].connected) {
+            send_to(&workers[i], &quit);
+            if (workers[i].connected)
+                remote_close(&workers[i].remote);
+        }
+    }
+    ASSERT_SYS_OK(close(listen_fd));
+    ASSERT_SYS_OK(unlink(socket_path));
+
+    solution_print(&frontier.best);
+    if (print_stats) {
+        Stats stats[workers_count + 1];
+        for (int i = 0; i < workers_count; i++)
+            stats[i] = workers[i].stats;
+        stats_print(stats, workers_count);
+        fprintf(stderr, "coordinator: splits=%lu branches_returned=%lu\n", splits, branches_returned);
+    }
+
+    free(fds);
+    free(fds_workers);
+    free(workers);
+    checkpoint_destroy(&frontier);
+    return 0;
+}
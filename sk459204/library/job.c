@@ -0,0 +1,94 @@
+#include "library/job.h"
+#include "common/bound.h"
+#include "common/cache.h"
+#include "common/err.h"
+#include "common/estimate.h"
+#include "common/io.h"
+#include "common/options.h"
+#include "parallel/search.h"
+
+#include <stdlib.h>
+
+typedef struct Job {
+    InputData input_data;
+    Options options;
+    Cache* cache;
+    Search_t* search;
+} Job;
+
+// Whether the bound named in the options exists, and if so sets `bound` to it (NULL for none).
+static bool find_bound(const MultisetOptions* multiset_options, BoundFunction* bound)
+{
+    *bound = NULL;
+    if (multiset_options->bound != NULL)
+        *bound = bound_function_by_name(multiset_options->bound);
+    return multiset_options->bound == NULL || *bound != NULL;
+}
+
+void* job_start(WorkerPool* pool, const TaskInput* task, const MultisetOptions* multiset_options)
+{
+    BoundFunction bound;
+    if (!find_bound(multiset_options, &bound))
+        return NULL;
+
+    Job* job = malloc(sizeof(Job));
+    if (job == NULL)
+        fatal("cannot allocate a job");
+    input_data_load(&job->input_data, task);
+    options_init(&job->options);
+    job->options.bound = bound;
+    job->options.cache_bytes = multiset_options->cache_bytes;
+    job->options.cache_max_sum = multiset_options->cache_max_sum;
+    job->cache = job->options.cache_bytes
+        ? cache_create(job->options.cache_bytes, task->d, job->options.cache_max_sum)
+        : NULL;
+    job->search = search_start(pool, &job->input_data, &job->options, job->cache, NULL, 0, -1);
+    return job;
+}
+
+bool job_poll(void* job)
+{
+    return search_poll(((Job*)job)->search);
+}
+
+void job_finish(void* opaque, MultisetSolution* solution)
+{
+    Job* job = opaque;
+    search_join(job->search);
+
+    const Solution* best = search_best(job->search);
+    solution->sum = best->sum;
+    for (int i = 0; i <= MULTISET_MAX_D; i++) {
+        solution->a[i] = i <= MAX_D ? best->a.count[i] : 0;
+        solution->b[i] = i <= MAX_D ? best->b.count[i] : 0;
+    }
+    solution->nodes = 0;
+    solution->pruned = 0;
+    for (int i = 0; i < search_workers(job->search); i++) {
+        solution->nodes += search_stats(job->search, i)->nodes_expanded;
+        solution->pruned += search_stats(job->search, i)->pruned;
+    }
+
+    search_destroy(job->search);
+    if (job->cache)
+        cache_destroy(job->cache);
+    free(job);
+}
+
+double job_estimate(const TaskInput* task, const MultisetOptions* multiset_options, int probes)
+{
+    BoundFunction bound;
+    if (!find_bound(multiset_options, &bound))
+        return -1;
+    InputData* input_data = malloc(sizeof(InputData));
+    if (input_data == NULL)
+        fatal("cannot allocate an instance");
+    input_data_load(input_data, task);
+    const Sumset* a = &input_data->a_start;
+    const Sumset* b = &input_data->b_start;
+    double nodes = 0;
+    if (input_data_start_kind(input_data) == SUMSET_NODE_OPEN)
+        nodes = estimate_node(input_data, a, b, NULL, sumset_node_is_symmetric(a, b), bound, 0, probes);
+    free(input_data);
+    return nodes;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "common/task.h"
+#include "common/width.h"
+#include "common/worker_pool.h"
+#include "library/multiset.h"
+
+#include <stdbool.h>
+
+// The width-specific half of a MultisetJob: one search (see parallel/search.h) with its input, options and cache,
+// compiled once per width like the solvers. Opaque to multiset.c, which picks the width.
+#define JOB_DECLARATIONS(width)                                                                                 \
+    void* job_start_d##width(WorkerPool* pool, const TaskInput* task, const MultisetOptions* options);         \
+    bool job_poll_d##width(void* job);                                                                          \
+    void job_finish_d##width(void* job, MultisetSolution* solution);                                          \
+    double job_estimate_d##width(const TaskInput* task, const MultisetOptions* options, int probes);
+SUMSET_FOR_EACH_WIDTH(JOB_DECLARATIONS)
+#undef JOB_DECLARATIONS
+
+#ifdef MAX_D
+// Start a search of the validated instance `task` with task->t of the pool's threads, NULL if the options are
+// invalid.
+#define job_start WIDTH_NAME(job_start)
+
+// Whether the search is over, without blocking.
+#define job_poll WIDTH_NAME(job_poll)
+
+// Wait for the search to be over, fill `solution` and free the job.
+#define job_finish WIDTH_NAME(job_finish)
+
+// Estimated size of the search of the validated instance `task`, -1 if the options are invalid.
+#define job_estimate WIDTH_NAME(job_estimate)
+#endif
@@ -0,0 +1,137 @@
+#include "library/multiset.h"
+#include "common/err.h"
+#include "common/task.h"
+#include "common/width.h"
+#include "common/worker_pool.h"
+#include "library/job.h"
+
+#include <stdlib.h>
+
+struct MultisetPool {
+    WorkerPool* workers;
+};
+
+// Jobs of each width, from the smallest.
+typedef struct JobFunctions {
+    int width;
+    void* (*start)(WorkerPool* pool, const TaskInput* task, const MultisetOptions* options);
+    bool (*poll)(void* job);
+    void (*finish)(void* job, MultisetSolution* solution);
+    double (*estimate)(const TaskInput* task, const MultisetOptions* options, int probes);
+} JobFunctions;
+
+#define JOB_FUNCTIONS(width) \
+    { width, job_start_d##width, job_poll_d##width, job_finish_d##width, job_estimate_d##width },
+static const JobFunctions job_functions[] = { SUMSET_FOR_EACH_WIDTH(JOB_FUNCTIONS) };
+#undef JOB_FUNCTIONS
+
+struct MultisetJob {
+    const JobFunctions* functions;
+    void* job;
+};
+
+void multiset_options_init(MultisetOptions* options)
+{
+    options->threads = 0;
+    options->bound = NULL;
+    options->cache_bytes = 0;
+    options->cache_max_sum = 0;
+}
+
+MultisetPool* multiset_pool_create(int threads)
+{
+    MultisetPool* pool = malloc(sizeof(MultisetPool));
+    if (pool == NULL)
+        fatal("cannot allocate a pool");
+    pool->workers = worker_pool_create(threads);
+    return pool;
+}
+
+void multiset_pool_destroy(MultisetPool* pool)
+{
+    worker_pool_destroy(pool->workers);
+    free(pool);
+}
+
+static bool elements_valid(const int* elements, int count, int d)
+{
+    if (count < 0)
+        return false;
+    for (int i = 0; i < count; i++) {
+        if (elements[i] < 1 || elements[i] > d)
+            return false;
+    }
+    return true;
+}
+
+// The jobs of the smallest width that fits the instance (see task_input_width), or NULL if it's invalid.
+static const JobFunctions* job_functions_for(const TaskInput* task)
+{
+    if (task->d < 3 || task->d > MULTISET_MAX_D || !elements_valid(task->a, task->n, task->d)
+        || !elements_valid(task->b, task->m, task->d))
+        return NULL;
+    int width = task_input_width(task);
+    for (size_t i = 0; i < sizeof(job_functions) / sizeof(job_functions[0]); i++) {
+        if (job_functions[i].width == width)
+            return &job_functions[i];
+    }
+    return NULL;
+}
+
+MultisetJob* multiset_submit(MultisetPool* pool, int d, const int* a0, int n, const int* b0, int m,
+    const MultisetOptions* options)
+{
+    int threads = worker_pool_threads(pool->workers);
+    if (options->threads > 0 && options->threads < threads)
+        threads = options->threads;
+    // The elements are only read.
+    TaskInput task = { .t = threads, .d = d, .n = n, .m = m, .a = (int*)a0, .b = (int*)b0, .bounded = true };
+    const JobFunctions* functions = job_functions_for(&task);
+    if (functions == NULL)
+        return NULL;
+
+    void* job = functions->start(pool->workers, &task, options);
+    if (job == NULL)
+        return NULL;
+
+    MultisetJob* multiset_job = malloc(sizeof(MultisetJob));
+    if (multiset_job == NULL)
+        fatal("cannot allocate a job");
+    multiset_job->functions = functions;
+    multiset_job->job = job;
+    return multiset_job;
+}
+
+bool multiset_poll(MultisetJob* job, MultisetSolution* solution)
+{
+    if (!job->functions->poll(job->job))
+        return false;
+    multiset_wait(job, solution);
+    return true;
+}
+
+void multiset_wait(MultisetJob* job, MultisetSolution* solution)
+{
+    job->functions->finish(job->job, solution);
+    free(job);
+}
+
+double multiset_estimate(int d, const int* a0, int n, const int* b0, int m, const MultisetOptions* options,
+    int probes)
+{
+    TaskInput task = { .t = 1, .d = d, .n = n, .m = m, .a = (int*)a0, .b = (int*)b0, .bounded = true };
+    const JobFunctions* functions = job_functions_for(&task);
+    if (functions == NULL)
+        return -1;
+    return functions->estimate(&task, options, probes);
+}
+
+bool multiset_solve(MultisetPool* pool, int d, const int* a0, int n, const int* b0, int m,
+    const MultisetOptions* options, MultisetSolution* solution)
+{
+    MultisetJob* job = multiset_submit(pool, d, a0, n, b0, m, options);
+    if (job == NULL)
+        return false;
+    multiset_wait(job, solution);
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+// libmultiset: computes α(d, A₀, B₀) from another program, with the search engine of the parallel solver
+// (parallel/search.h). There's no global state: instances are solved by a pool of threads that lives as long as
+// the caller wants, any number of them side by side or one after another, each with its own options. Doesn't
+// depend on the sumset width: each instance runs with the smallest width that fits it (see common/width.h).
+//
+// Running out of memory still quits the process, like everywhere else in this project.
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Largest d supported (SUMSET_MAX_WIDTH).
+#define MULTISET_MAX_D 128
+
+typedef struct MultisetOptions {
+    // Threads of the pool the instance may use at once, 0 for all of them.
+    int threads;
+
+    // Prune with the bound of this name (see common/bound.h, e.g. "pigeonhole"), NULL to explore the whole tree.
+    const char* bound;
+
+    // Memory budget of the transposition cache of the instance (see common/cache.h), 0 for no cache.
+    size_t cache_bytes;
+
+    // Only nodes whose larger sum is at most this are looked up in the cache, 0 for d²/20 (see common/cache.h).
+    int cache_max_sum;
+} MultisetOptions;
+
+typedef struct MultisetSolution {
+    int sum; // α(d, A₀, B₀) = ∑A = ∑B, 0 if there's no undisputed pair
+    int a[MULTISET_MAX_D + 1]; // a[i] is the number of i in A, 0 above d
+    int b[MULTISET_MAX_D + 1];
+    unsigned long nodes; // nodes expanded by the search
+    unsigned long pruned; // nodes pruned by the bound
+} MultisetSolution;
+
+typedef struct MultisetPool MultisetPool;
+
+// An instance being solved.
+typedef struct MultisetJob MultisetJob;
+
+// Set the defaults: all threads of the pool, no bound, no cache.
+void multiset_options_init(MultisetOptions* options);
+
+// Start a pool of `threads` threads (at least 1).
+MultisetPool* multiset_pool_create(int threads);
+
+// Wait for the instances submitted to the pool to be solved, then stop its threads. Their jobs must still be
+// waited for (or polled until done).
+void multiset_pool_destroy(MultisetPool* pool);
+
+// Start solving α(d, A₀, B₀) on the pool, with A₀ given by n elements a0[0..n) and B₀ by m elements b0[0..m), and
+// return at once. Instances get threads in the order they were submitted. Returns NULL if the instance is invalid
+// (d not in [3, MULTISET_MAX_D], an element not in [1, d], ∑A₀ or ∑B₀ not below MULTISET_MAX_D²) or so are the
+// options (an unknown bound).
+MultisetJob* multiset_submit(MultisetPool* pool, int d, const int* a0, int n, const int* b0, int m,
+    const MultisetOptions* options);
+
+// If the job is done, fill `solution`, free the job and return true. Otherwise return false at once.
+bool multiset_poll(MultisetJob* job, MultisetSolution* solution);
+
+// Wait for the job to be done, fill `solution` and free the job.
+void multiset_wait(MultisetJob* job, MultisetSolution* solution);
+
+// Estimated number of nodes the search of the instance expands, from `probes` random walks (see
+// common/estimate.h), without solving it. Takes about a microsecond per walk. Returns -1 if the instance or the
+// options are invalid, see multiset_submit.
+double multiset_estimate(int d, const int* a0, int n, const int* b0, int m, const MultisetOptions* options,
+    int probes);
+
+// Submit and wait: fill `solution` with α(d, A₀, B₀) and a pair reaching it. Returns false (with `solution`
+// untouched) if the instance or the options are invalid, see multiset_submit.
+bool multiset_solve(MultisetPool* pool, int d, const int* a0, int n, const int* b0, int m,
+    const MultisetOptions* options, MultisetSolution* solution);
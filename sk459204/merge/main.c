@@ -0,0 +1,107 @@
+// Merges the outputs of a search split with --shard=K/N into the output of the whole search.
+//
+// Usage: merge [FILE...] (standard input if no files are given)
+//
+// Each shard prints "shard K/N input D A_0 B_0" (see shard_print_header) followed by its best solution (sum, A, B;
+// see solution_print). All N shards must be present exactly once, all with the same input; the solution with the
+// largest sum (from the first shard on ties) is printed as the solver would print it.
+#include "common/err.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct ShardOutput {
+    bool seen;
+    int sum;
+    char* a; // A and B lines, as printed (with the newline)
+    char* b;
+} ShardOutput;
+
+static ShardOutput* shards = NULL;
+static int shards_count = 0;
+static char* input = NULL; // the rest of the first header, " input D A_0 B_0" (with the newline)
+
+static char* read_line(FILE* file, const char* name)
+{
+    char* line = NULL;
+    size_t size = 0;
+    if (getline(&line, &size, file) < 0)
+        fatal("%s: truncated shard output", name);
+    return line;
+}
+
+static void read_shards(FILE* file, const char* name)
+{
+    int k, n;
+    int read;
+    while ((read = fscanf(file, " shard %d/%d", &k, &n)) == 2) {
+        char* shard_input = read_line(file, name);
+        if (strncmp(shard_input, " input ", strlen(" input ")) != 0)
+            fatal("%s: shard %d/%d has no input", name, k, n);
+        if (input == NULL)
+            input = shard_input;
+        else if (strcmp(shard_input, input) != 0)
+            fatal("%s: shard %d/%d is from a different input than the others", name, k, n);
+        else
+            free(shard_input);
+        if (shards == NULL) {
+            if (n < 1)
+                fatal("%s: bad shard count %d", name, n);
+            shards_count = n;
+            shards = calloc(n, sizeof(ShardOutput));
+            if (shards == NULL)
+                fatal("cannot allocate %d shards", n);
+        }
+        if (n != shards_count)
+            fatal("%s: shard %d/%d of a search split into %d shards", name, k, n, shards_count);
+        if (k < 1 || k > n)
+            fatal("%s: bad shard %d/%d", name, k, n);
+        ShardOutput* shard = &shards[k - 1];
+        if (shard->seen)
+            fatal("%s: shard %d/%d given twice", name, k, n);
+        shard->seen = true;
+
+        if (fscanf(file, "%d", &shard->sum) != 1 || fgetc(file) != '\n')
+            fatal("%s: malformed output of shard %d/%d", name, k, n);
+        shard->a = read_line(file, name);
+        shard->b = read_line(file, name);
+    }
+    if (read != EOF)
+        fatal("%s: expected \"shard K/N input ...\"", name);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 1) {
+        read_shards(stdin, "stdin");
+    } else {
+        for (int i = 1; i < argc; i++) {
+            FILE* file = fopen(argv[i], "r");
+            if (file == NULL)
+                syserr("cannot open %s", argv[i]);
+            read_shards(file, argv[i]);
+            fclose(file);
+        }
+    }
+
+    if (shards == NULL)
+        fatal("no shard outputs");
+    const ShardOutput* best = NULL;
+    for (int k = 0; k < shards_count; k++) {
+        if (!shards[k].seen)
+            fatal("shard %d/%d is missing", k + 1, shards_count);
+        if (best == NULL || shards[k].sum > best->sum)
+            best = &shards[k];
+    }
+    printf("%d\n%s%s", best->sum, best->a, best->b);
+
+    for (int k = 0; k < shards_count; k++) {
+        free(shards[k].a);
+        free(shards[k].b);
+    }
+    free(shards);
+    free(input);
+    return 0;
+}
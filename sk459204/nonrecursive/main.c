@@ -1,11 +1,22 @@
 #include <stddef.h>
 
+#include "common/cache.h"
+#include "common/checkpoint.h"
+#include "common/estimate.h"
 #include "common/io.h"
+#include "common/options.h"
+#include "common/shard.h"
+#include "common/stats.h"
 #include "common/sumset.h"
+#include "common/sweep.h"
 
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 
+#define FRAME_CHUNK_SIZE 64
+#define CLOCK_POLL_NODES 65536
+
 typedef struct SmartSumset {
     Sumset sumset;
     struct SmartSumset* parent;
@@ -20,55 +31,160 @@ typedef struct Stack {
     int stack_size;
 } Stack_t;
 
+// A node of the frames engine: an open node (a, b) with ∑a ≤ ∑b, its open children that are still
+// to be visited, and the buffer the current child is built in (the next frame points to it).
+typedef struct Frame {
+    const Sumset* a;
+    const Sumset* b;
+    ElementSet children;
+    Sumset child;
+} Frame_t;
+
+// Frames are allocated in chunks that never move, since deeper frames point into shallower ones.
+typedef struct FrameStack {
+    Frame_t** chunks;
+    int chunks_count;
+    int chunks_size;
+} FrameStack_t;
+
+// Sumsets are allocated in chunks that never move, since they point to their parents and the stacks point to them.
 typedef struct SmartSumsetPool {
-    SmartSumset_t* pool;
+    SmartSumset_t** chunks;
+    int chunks_count;
     SmartSumset_t* free_list;
-    int pool_size;
+    int pool_size; // sumsets in all chunks
 } SmartSumsetPool_t;
 
-SmartSumsetPool_t* pool_init(int pool_size) {
-    SmartSumsetPool_t* pool = (SmartSumsetPool_t*) malloc(sizeof(SmartSumsetPool_t));
-    pool->pool = (SmartSumset_t*) malloc(pool_size * sizeof(SmartSumset_t));
-    pool->free_list = &pool->pool[0];
-    pool->pool_size = pool_size;
+static Stats stats;
+
+static Cache* cache;
+
+static Sweep sweep; // best solutions for every d', if options->sweep
+
+// Checkpointing (see checkpoint.h): the checkpoint resumed from, or this shard's part of the search (see shard.h),
+// whose branches before resumed_next were already started, when this run started, and when the next checkpoint is due.
+static Checkpoint resumed;
+static int resumed_next;
+static uint64_t start_ns;
+static uint64_t checkpoint_due_ns = UINT64_MAX;
 
-    for (int i = 0; i < pool_size - 1; ++i) {
-        pool->pool[i].next_on_free_list = &pool->pool[i + 1];
+// Progress reports (see estimate.h): the estimated size of the search, and when the next report is due.
+static double estimated_nodes;
+static uint64_t progress_due_ns = UINT64_MAX;
+
+// The deadline (see Options), and the search left when it or reaching the target (see Options) stopped the search
+// (then `stopped` is set).
+static uint64_t deadline_ns = UINT64_MAX;
+static bool target_reached;
+static bool stopped;
+static Checkpoint left;
+
+// When the clock says a checkpoint, a progress report or the deadline is due, UINT64_MAX if none ever is.
+static uint64_t clock_due_ns = UINT64_MAX;
+
+static void clock_schedule(void) {
+    clock_due_ns = checkpoint_due_ns < progress_due_ns ? checkpoint_due_ns : progress_due_ns;
+    if (deadline_ns < clock_due_ns) {
+        clock_due_ns = deadline_ns;
     }
-    pool->pool[pool_size - 1].next_on_free_list = NULL;
+}
+
+// Called once per node: whether a checkpoint, a progress report or the deadline is due, or the target was reached.
+// The clock is only read every CLOCK_POLL_NODES nodes.
+static bool clock_is_due(void) {
+    static int polls = 0;
+    if (target_reached) {
+        return true;
+    }
+    if (clock_due_ns == UINT64_MAX || ++polls < CLOCK_POLL_NODES) {
+        return false;
+    }
+    polls = 0;
+    return stats_now_ns() >= clock_due_ns;
+}
+
+// Prints a progress report if one is due.
+static void progress_report(const Options* options) {
+    uint64_t now = stats_now_ns();
+    if (now < progress_due_ns) {
+        return;
+    }
+    estimate_print_progress(estimated_nodes, resumed.stats.nodes_expanded + stats.nodes_expanded,
+        resumed.stats.nodes_expanded, now - start_ns);
+    progress_due_ns = now + options->progress_interval * 1000000000ULL;
+    clock_schedule();
+}
+
+// Adds the resumed branches not started yet to the frontier of the running search, with the best solution
+// and the counters so far, which makes it all that's left of the search.
+static void frontier_complete(Solution* best_solution, Checkpoint* frontier) {
+    for (int i = resumed_next; i < resumed.branches_count; ++i) {
+        checkpoint_add(frontier, &resumed.branches[i]);
+    }
+    frontier->best = *best_solution;
+    frontier->stats = stats;
+    frontier->stats.run_ns = stats_now_ns() - start_ns;
+    stats_add_run(&frontier->stats, &resumed.stats);
+}
 
+// Writes a checkpoint with the frontier of the running search and the resumed branches not started yet.
+static void checkpoint_save(InputData* input_data, const Options* options, Solution* best_solution, Checkpoint* frontier) {
+    frontier_complete(best_solution, frontier);
+    checkpoint_write(frontier, options->checkpoint_path, input_data);
+    checkpoint_due_ns = stats_now_ns() + options->checkpoint_interval * 1000000000ULL;
+    clock_schedule();
+}
+
+// Adds a chunk of `size` sumsets to the free list.
+static void pool_add_chunk(SmartSumsetPool_t* pool, int size) {
+    SmartSumset_t* chunk = (SmartSumset_t*) malloc(size * sizeof(SmartSumset_t));
+    for (int i = 0; i < size - 1; ++i) {
+        chunk[i].next_on_free_list = &chunk[i + 1];
+    }
+    chunk[size - 1].next_on_free_list = pool->free_list;
+    pool->free_list = &chunk[0];
+
+    pool->chunks = (SmartSumset_t**) realloc(pool->chunks, (pool->chunks_count + 1) * sizeof(SmartSumset_t*));
+    pool->chunks[pool->chunks_count++] = chunk;
+    pool->pool_size += size;
+}
+
+static SmartSumsetPool_t* pool_init(int pool_size) {
+    SmartSumsetPool_t* pool = (SmartSumsetPool_t*) malloc(sizeof(SmartSumsetPool_t));
+    pool->chunks = NULL;
+    pool->chunks_count = 0;
+    pool->free_list = NULL;
+    pool->pool_size = 0;
+    pool_add_chunk(pool, pool_size);
     return pool;
 }
 
-SmartSumset_t* pool_get(SmartSumsetPool_t* pool) {
+static SmartSumset_t* pool_get(SmartSumsetPool_t* pool) {
     if (pool->free_list == NULL) {
-        pool->pool = (SmartSumset_t*) realloc(pool->pool, 2 * pool->pool_size * sizeof(SmartSumset_t));
-        pool->pool_size *= 2;
-        pool->free_list = &pool->pool[pool->pool_size / 2];
-
-        for (int i = pool->pool_size / 2; i < pool->pool_size - 1; ++i) {
-            pool->pool[i].next_on_free_list = &pool->pool[i + 1];
-        }
-        pool->pool[pool->pool_size - 1].next_on_free_list = NULL;
+        pool_add_chunk(pool, pool->pool_size);
     }
 
     SmartSumset_t* result = pool->free_list;
     pool->free_list = result->next_on_free_list;
+    stats.pool_allocs++;
 
     return result;
 }
 
-void pool_return(SmartSumsetPool_t* pool, SmartSumset_t* smart_sumset) {
+static void pool_return(SmartSumsetPool_t* pool, SmartSumset_t* smart_sumset) {
     smart_sumset->next_on_free_list = pool->free_list;
     pool->free_list = smart_sumset;
 }
 
-void pool_destroy(SmartSumsetPool_t* pool) {
-    free(pool->pool);
+static void pool_destroy(SmartSumsetPool_t* pool) {
+    for (int i = 0; i < pool->chunks_count; ++i) {
+        free(pool->chunks[i]);
+    }
+    free(pool->chunks);
     free(pool);
 }
 
-Stack_t* stack_init(int stack_size) {
+static Stack_t* stack_init(int stack_size) {
     Stack_t* stack = (Stack_t*) malloc(sizeof(Stack_t));
     stack->stack = (SmartSumset_t**) malloc(stack_size * sizeof(SmartSumset_t*));
     stack->last_push_index = -1;
@@ -76,7 +192,7 @@ Stack_t* stack_init(int stack_size) {
     return stack;
 }
 
-void stack_push(Stack_t* stack, SmartSumset_t* a, SmartSumset_t* b) {
+static void stack_push(Stack_t* stack, SmartSumset_t* a, SmartSumset_t* b) {
     stack->last_push_index += 2;
     if (stack->last_push_index == stack->stack_size) {
         stack->stack = (SmartSumset_t**) realloc(stack->stack, 2 * stack->stack_size * sizeof(SmartSumset_t*));
@@ -87,28 +203,56 @@ void stack_push(Stack_t* stack, SmartSumset_t* a, SmartSumset_t* b) {
     stack->stack[stack->last_push_index] = b;
 }
 
-void stack_pop(Stack_t* stack, SmartSumset_t** a, SmartSumset_t** b) {
+static void stack_pop(Stack_t* stack, SmartSumset_t** a, SmartSumset_t** b) {
     *b = stack->stack[stack->last_push_index];
     *a = stack->stack[stack->last_push_index - 1];
     stack->last_push_index -= 2;
 }
 
-bool stack_is_empty(Stack_t* stack) {
+static bool stack_is_empty(Stack_t* stack) {
     return stack->last_push_index == -1;
 }
 
-void stack_destroy(Stack_t* stack) {
+static void stack_destroy(Stack_t* stack) {
     free(stack->stack);
     free(stack);
 }
 
-void smart_sumset_swap(SmartSumset_t** a, SmartSumset_t** b) {
+static FrameStack_t* frame_stack_init() {
+    FrameStack_t* frames = (FrameStack_t*) malloc(sizeof(FrameStack_t));
+    frames->chunks_size = 16;
+    frames->chunks_count = 0;
+    frames->chunks = (Frame_t**) malloc(frames->chunks_size * sizeof(Frame_t*));
+    return frames;
+}
+
+static Frame_t* frame_stack_at(FrameStack_t* frames, int depth) {
+    int chunk = depth / FRAME_CHUNK_SIZE;
+    while (chunk >= frames->chunks_count) {
+        if (frames->chunks_count == frames->chunks_size) {
+            frames->chunks_size *= 2;
+            frames->chunks = (Frame_t**) realloc(frames->chunks, frames->chunks_size * sizeof(Frame_t*));
+        }
+        frames->chunks[frames->chunks_count++] = (Frame_t*) malloc(FRAME_CHUNK_SIZE * sizeof(Frame_t));
+    }
+    return &frames->chunks[chunk][depth % FRAME_CHUNK_SIZE];
+}
+
+static void frame_stack_destroy(FrameStack_t* frames) {
+    for (int i = 0; i < frames->chunks_count; ++i) {
+        free(frames->chunks[i]);
+    }
+    free(frames->chunks);
+    free(frames);
+}
+
+static void smart_sumset_swap(SmartSumset_t** a, SmartSumset_t** b) {
     SmartSumset_t* tmp = *a;
     *a = *b;
     *b = tmp;
 }
 
-void check_sumset_reference_count(SmartSumsetPool_t* pool, SmartSumset_t* sumset) {
+static void check_sumset_reference_count(SmartSumsetPool_t* pool, SmartSumset_t* sumset) {
     while (sumset != NULL && --sumset->reference_count == 0) {
         SmartSumset_t* tmp = sumset;
         sumset = sumset->parent;
@@ -116,53 +260,394 @@ void check_sumset_reference_count(SmartSumsetPool_t* pool, SmartSumset_t* sumset
     }
 }
 
-void nonrecursive_pool_solv_no_pairs(InputData* input_data, Solution* best_solution) {
+// Whether the node (a, b) can't beat the best solution found so far, or reach the target.
+static bool is_pruned(InputData* input_data, const Options* options, Solution* best_solution, const Sumset* a, const Sumset* b) {
+    int best = best_solution->sum > options->target - 1 ? best_solution->sum : options->target - 1;
+    if (options->bound == NULL) {
+        return false;
+    }
+    if (options->sweep ? !sweep_is_pruned(&sweep, options->bound, a, b) : options->bound(a, b, input_data->d) > best) {
+        return false;
+    }
+    stats.pruned++;
+    return true;
+}
+
+// Whether the node (a, b), or one dominating it, was already visited through another path.
+static bool is_cached(const Sumset* a, const Sumset* b) {
+    if (cache == NULL || !cache_covers(cache, b)) {
+        return false;
+    }
+    if (cache_visit(cache, a, b)) {
+        stats.cache_hits++;
+        return true;
+    }
+    stats.cache_misses++;
+    return false;
+}
+
+// Stops the search (before the next node) once the best solution reaches the target.
+static void check_target(const Options* options, Solution* best_solution) {
+    if (options->target && best_solution->sum >= options->target) {
+        target_reached = true;
+    }
+}
+
+static void record_solution(InputData* input_data, const Options* options, Solution* best_solution, const Sumset* a, const Sumset* b) {
+    stats.terminal_checks++;
+    if (options->sweep) {
+        sweep_record(&sweep, input_data, a, b);
+    } else if (a->sum > best_solution->sum) {
+        solution_build(best_solution, input_data, a, b);
+        check_target(options, best_solution);
+    }
+}
+
+// Sets up the frame for the open node (a, b): records its terminal children and keeps the open ones for later.
+static void frame_enter(InputData* input_data, const Options* options, Solution* best_solution, Frame_t* frame, const Sumset* a, const Sumset* b) {
+    if (a->sum > b->sum) {
+        const Sumset* tmp = a;
+        a = b;
+        b = tmp;
+    }
+    frame->a = a;
+    frame->b = b;
+
+    if (is_pruned(input_data, options, best_solution, a, b) || is_cached(a, b)) {
+        frame->children = (ElementSet) { 0 };
+        return;
+    }
+
+    SumsetChildren children;
+    sumset_expand(a, b, input_data->d, &children);
+    stats.nodes_expanded++;
+    stats.children_generated += element_set_size(&children.all);
+    stats.children_rejected += children.rejected;
+    while (!element_set_is_empty(&children.terminal)) { // s(a_with_i) ∩ s(b) = {0, ∑b}.
+        int i = element_set_pop_min(&children.terminal);
+        sumset_add(&frame->child, a, i);
+        record_solution(input_data, options, best_solution, &frame->child, b);
+    }
+    frame->children = children.open;
+}
+
+// Adds the unvisited children of all frames up to `depth` to the frontier, deepest first (in the order they'd be
+// visited, so that the resumed search finds the same solution). Children of a symmetric root are added one by one,
+// each with its own copy of b with last raised.
+static void frames_frontier(InputData* input_data, FrameStack_t* frames, int depth, bool symmetric, Checkpoint* frontier) {
+    Branch branch;
+    for (int k = depth; k >= 0; --k) {
+        Frame_t* frame = frame_stack_at(frames, k);
+        if (element_set_is_empty(&frame->children)) {
+            continue;
+        }
+        if (k > 0 || !symmetric) {
+            branch_init(&branch, input_data, frame->a, frame->b, &frame->children);
+            checkpoint_add(frontier, &branch);
+            continue;
+        }
+        ElementSet children = frame->children;
+        while (!element_set_is_empty(&children)) {
+            int i = element_set_pop_min(&children);
+            ElementSet child = { 0 };
+            child.bits[i / BITS_PER_WORD] |= ((Word)1) << (i % BITS_PER_WORD);
+            branch_init(&branch, input_data, frame->a, frame->b, &child);
+            branch.b.last = i;
+            checkpoint_add(frontier, &branch);
+        }
+    }
+}
+
+// One DFS of the frames engine (see frames_solv). A cursor whose root frame came from another cursor owns the chains
+// its sides were rebuilt in (see branch_side_build), since the other cursor reuses its frame buffers.
+typedef struct Cursor {
+    FrameStack_t* frames;
+    int depth; // deepest frame in use, -1 if the cursor has nothing to visit
+    bool symmetric; // whether the root frame is a symmetric root (see sumset_node_is_symmetric)
+    Sumset* a_chain; // NULL if the root frame is the node frames_solv was given
+    Sumset* b_chain;
+    Sumset b_from_i; // children of a symmetric root are expanded against a copy of b with last raised
+} Cursor_t;
+
+// Adds the unvisited children of all cursors to the frontier.
+static void cursors_frontier(InputData* input_data, Cursor_t* cursors, int count, Checkpoint* frontier) {
+    for (int c = 0; c < count; ++c) {
+        frames_frontier(input_data, cursors[c].frames, cursors[c].depth, cursors[c].symmetric, frontier);
+    }
+}
+
+// Saves the unvisited children of all cursors, and the rest of the search.
+static void cursors_checkpoint(InputData* input_data, const Options* options, Solution* best_solution, Cursor_t* cursors, int count) {
+    Checkpoint frontier;
+    checkpoint_init(&frontier);
+    cursors_frontier(input_data, cursors, count, &frontier);
+    checkpoint_save(input_data, options, best_solution, &frontier);
+    checkpoint_destroy(&frontier);
+}
+
+// Gives the idle cursor `thief` the half of the unvisited children of the shallowest frame (of all cursors) that has
+// any that its cursor would get to last. Returns false if no cursor has any.
+static bool cursor_steal(InputData* input_data, const Options* options, Cursor_t* cursors, int count, Cursor_t* thief) {
+    Cursor_t* victim = NULL;
+    Frame_t* frame = NULL;
+    int shallowest = 0;
+    for (int c = 0; c < count; ++c) {
+        for (int k = 0; k <= cursors[c].depth && (victim == NULL || k < shallowest); ++k) {
+            Frame_t* candidate = frame_stack_at(cursors[c].frames, k);
+            if (!element_set_is_empty(&candidate->children)) {
+                victim = &cursors[c];
+                frame = candidate;
+                shallowest = k;
+                break;
+            }
+        }
+    }
+    if (victim == NULL) {
+        return false;
+    }
+
+    int size = element_set_size(&frame->children);
+    ElementSet stolen;
+    if (options->larger_first) {
+        // Visited from the largest element (see frames_solv), the smallest ones are the ones it'd get to last.
+        ElementSet kept;
+        element_set_split(&frame->children, (size + 1) / 2, &kept);
+        stolen = frame->children;
+        frame->children = kept;
+    } else {
+        element_set_split(&frame->children, size / 2, &stolen);
+    }
+
+    Frame_t* root = frame_stack_at(thief->frames, 0);
+    root->children = stolen;
+    thief->depth = 0;
+    free(thief->a_chain);
+    free(thief->b_chain);
+    if (shallowest == 0 && victim->a_chain == NULL) {
+        // The node frames_solv was given outlives all cursors.
+        root->a = frame->a;
+        root->b = frame->b;
+        thief->symmetric = victim->symmetric;
+        thief->a_chain = NULL;
+        thief->b_chain = NULL;
+        return true;
+    }
+    Branch branch;
+    branch_init(&branch, input_data, frame->a, frame->b, NULL);
+    thief->a_chain = (Sumset*) malloc((branch_side_size(&branch.a) + 2) * sizeof(Sumset));
+    thief->b_chain = (Sumset*) malloc((branch_side_size(&branch.b) + 2) * sizeof(Sumset));
+    root->a = branch_side_build(&branch.a, input_data, thief->a_chain);
+    root->b = branch_side_build(&branch.b, input_data, thief->b_chain);
+    thief->symmetric = false;
+    return true;
+}
+
+// Hints the CPU to bring in the sides of the node the cursor visits next.
+static void cursor_prefetch(Cursor_t* cursor) {
+    if (cursor->depth >= 0) {
+        Frame_t* frame = frame_stack_at(cursor->frames, cursor->depth);
+        sumset_prefetch(frame->a);
+        sumset_prefetch(frame->b);
+    }
+}
+
+// Iterative DFS on explicit frames: each frame keeps a cursor (the set of children still to visit)
+// and builds one child at a time into its buffer, so memory is O(depth) and nothing is reference counted.
+// Children are visited from the smallest element added, or from the largest one (see Options.larger_first).
+// Explores the open node (a, b), or only its open children (a ∪ {x}, b) for x in `children` if that's not NULL.
+//
+// With Options.cursors > 1, that many DFS cursors take turns, one node each, and the sides of the next cursor's node
+// are prefetched while the current one's is expanded. A cursor that runs out of nodes takes over part of another
+// one's (see cursor_steal), so the tree explored is the same, only the order changes.
+static void frames_solv(InputData* input_data, const Options* options, Solution* best_solution, const Sumset* a, const Sumset* b, const ElementSet* children, bool symmetric) {
+    int count = options->cursors;
+    Cursor_t* cursors = (Cursor_t*) malloc(count * sizeof(Cursor_t));
+    for (int c = 0; c < count; ++c) {
+        cursors[c].frames = frame_stack_init();
+        cursors[c].depth = -1;
+        cursors[c].symmetric = false;
+        cursors[c].a_chain = NULL;
+        cursors[c].b_chain = NULL;
+    }
+    if (children == NULL) {
+        frame_enter(input_data, options, best_solution, frame_stack_at(cursors[0].frames, 0), a, b);
+    } else {
+        Frame_t* root = frame_stack_at(cursors[0].frames, 0);
+        root->a = a;
+        root->b = b;
+        root->children = *children;
+    }
+    cursors[0].depth = 0;
+    cursors[0].symmetric = symmetric;
+
+    int active = 1; // cursors with a node to visit
+    for (int c = 0; active > 0; c = c + 1 < count ? c + 1 : 0) {
+        Cursor_t* cursor = &cursors[c];
+        if (cursor->depth < 0) {
+            if (!cursor_steal(input_data, options, cursors, count, cursor)) {
+                continue;
+            }
+            active++;
+        }
+
+        if (clock_is_due()) {
+            if (target_reached || stats_now_ns() >= deadline_ns) {
+                cursors_frontier(input_data, cursors, count, &left);
+                frontier_complete(best_solution, &left);
+                stopped = true;
+                break;
+            }
+            if (stats_now_ns() >= checkpoint_due_ns) {
+                cursors_checkpoint(input_data, options, best_solution, cursors, count);
+            }
+            progress_report(options);
+        }
+
+        int depth = cursor->depth;
+        Frame_t* frame = frame_stack_at(cursor->frames, depth);
+        while (element_set_is_empty(&frame->children) && --depth >= 0) {
+            frame = frame_stack_at(cursor->frames, depth);
+        }
+        cursor->depth = depth;
+        if (depth < 0) {
+            active--;
+            continue;
+        }
+        if (count > 1) {
+            cursor_prefetch(&cursors[c + 1 < count ? c + 1 : 0]);
+        }
+
+        int i = options->larger_first ? element_set_pop_max(&frame->children) : element_set_pop_min(&frame->children);
+        sumset_add(&frame->child, frame->a, i);
+        const Sumset* b = frame->b;
+        if (depth == 0 && cursor->symmetric) {
+            sumset_copy(&cursor->b_from_i, b);
+            cursor->b_from_i.last = i;
+            b = &cursor->b_from_i;
+        }
+        cursor->depth = depth + 1;
+        frame_enter(input_data, options, best_solution, frame_stack_at(cursor->frames, depth + 1), &frame->child, b);
+    }
+
+    for (int c = 0; c < count; ++c) {
+        frame_stack_destroy(cursors[c].frames);
+        free(cursors[c].a_chain);
+        free(cursors[c].b_chain);
+    }
+    free(cursors);
+}
+
+// Adds the open nodes on the stack to the frontier, from the top (in the order they'd be visited).
+static void pool_frontier(InputData* input_data, Stack_t* stack, Checkpoint* frontier) {
+    Branch branch;
+    for (int i = stack->last_push_index - 1; i >= 0; i -= 2) {
+        branch_init(&branch, input_data, &stack->stack[i]->sumset, &stack->stack[i + 1]->sumset, NULL);
+        checkpoint_add(frontier, &branch);
+    }
+}
+
+// Saves the open nodes on the stack, and the rest of the search.
+static void pool_checkpoint(InputData* input_data, const Options* options, Solution* best_solution, Stack_t* stack) {
+    Checkpoint frontier;
+    checkpoint_init(&frontier);
+    pool_frontier(input_data, stack, &frontier);
+    checkpoint_save(input_data, options, best_solution, &frontier);
+    checkpoint_destroy(&frontier);
+}
+
+// Explores the open node (a_root, b_root), or only its open children (a_root ∪ {x}, b_root) for x in `children`
+// if that's not NULL, pushing all open children of a node on a stack (so they're visited from the largest element added).
+static void nonrecursive_pool_solv_no_pairs(InputData* input_data, const Options* options, Solution* best_solution, const Sumset* a_root, const Sumset* b_root, const ElementSet* children, bool symmetric) {
     SmartSumsetPool_t* pool = pool_init(1024);
 
     SmartSumset_t* a = pool_get(pool);
-    a->sumset = input_data->a_start;
+    sumset_copy(&a->sumset, a_root);
     a->parent = NULL;
     a->reference_count = 2;
 
     SmartSumset_t* b = pool_get(pool);
-    b->sumset = input_data->b_start;
+    sumset_copy(&b->sumset, b_root);
     b->parent = NULL;
     b->reference_count = 2;
 
     Stack_t* stack = stack_init(4096);
-    stack_push(stack, a, b);
+    if (children == NULL) {
+        stack_push(stack, a, b);
+    } else {
+        ElementSet open = *children;
+        while (!element_set_is_empty(&open)) {
+            SmartSumset_t* a_with_i = pool_get(pool);
+            a_with_i->reference_count = 1;
+            a_with_i->parent = a;
+            sumset_add(&a_with_i->sumset, &a->sumset, element_set_pop_min(&open));
+            stack_push(stack, a_with_i, b);
+            a->reference_count++;
+            b->reference_count++;
+        }
+    }
 
     int counter;
 
+    // Only open nodes (s(a) ∩ s(b) = {0}) are ever pushed.
     while (!stack_is_empty(stack)) {
+        if (clock_is_due()) {
+            if (target_reached || stats_now_ns() >= deadline_ns) {
+                pool_frontier(input_data, stack, &left);
+                frontier_complete(best_solution, &left);
+                stopped = true;
+                break;
+            }
+            if (stats_now_ns() >= checkpoint_due_ns) {
+                pool_checkpoint(input_data, options, best_solution, stack);
+            }
+            progress_report(options);
+        }
+
         stack_pop(stack, &a, &b);
 
         if (a->sumset.sum > b->sumset.sum) {
             smart_sumset_swap(&a, &b);
         }
 
-        if (is_sumset_intersection_trivial(&a->sumset, &b->sumset)) { // s(a) ∩ s(b) = {0}.
+        if (!is_pruned(input_data, options, best_solution, &a->sumset, &b->sumset)
+            && !is_cached(&a->sumset, &b->sumset)) {
             counter = 0;
-            for (size_t i = a->sumset.last; i <= input_data->d; ++i) {
-                if (!does_sumset_contain(&b->sumset, i)) {
+            SumsetChildren children;
+            sumset_expand(&a->sumset, &b->sumset, input_data->d, &children);
+            stats.nodes_expanded++;
+            stats.children_generated += element_set_size(&children.all);
+            stats.children_rejected += children.rejected;
+            while (!element_set_is_empty(&children.all)) {
+                int i = element_set_pop_min(&children.all);
+                if (element_set_contains(&children.open, i)) {
                     SmartSumset_t* a_with_i = pool_get(pool);
                     a_with_i->reference_count = 1;
                     a_with_i->parent = a;
                     sumset_add(&a_with_i->sumset, &a->sumset, i);
 
+                    // Children of a symmetric root get their own copy of b with last raised (see sumset_node_is_symmetric).
+                    if (symmetric) {
+                        SmartSumset_t* b_from_i = pool_get(pool);
+                        b_from_i->reference_count = 1;
+                        b_from_i->parent = b;
+                        sumset_copy(&b_from_i->sumset, &b->sumset);
+                        b_from_i->sumset.last = i;
+                        stack_push(stack, a_with_i, b_from_i);
+                    } else {
+                        stack_push(stack, a_with_i, b);
+                    }
                     counter++;
-
-                    stack_push(stack, a_with_i, b);
+                } else { // s(a_with_i) ∩ s(b) = {0, ∑b}.
+                    Sumset a_with_i;
+                    sumset_add(&a_with_i, &a->sumset, i);
+                    record_solution(input_data, options, best_solution, &a_with_i, &b->sumset);
                 }
             }
 
             a->reference_count += counter;
             b->reference_count += counter;
-        } else if ((a->sumset.sum == b->sumset.sum) && (get_sumset_intersection_size(&a->sumset, &b->sumset) == 2)) { // s(a) ∩ s(b) = {0, ∑b}.
-            if (a->sumset.sum > best_solution->sum) {
-                solution_build(best_solution, input_data, &a->sumset, &b->sumset);
-            }
         }
+        symmetric = false;
         check_sumset_reference_count(pool, a);
         check_sumset_reference_count(pool, b);
     }
@@ -171,17 +656,145 @@ void nonrecursive_pool_solv_no_pairs(InputData* input_data, Solution* best_solut
     pool_destroy(pool);
 }
 
-int main()
+
+// Explores the open node (a, b), or only its open children (a ∪ {x}, b) for x in `children` if that's not NULL.
+typedef void (*BranchSolver)(InputData* input_data, const Options* options, Solution* best_solution, const Sumset* a, const Sumset* b, const ElementSet* children, bool symmetric);
+
+// Runs the search from the start node, or from the branches of the resumed checkpoint one by one.
+static void solve(InputData* input_data, const Options* options, Solution* best_solution, BranchSolver solver) {
+    if (resumed.branches_count == 0) {
+        switch (input_data_start_kind(input_data)) {
+        case SUMSET_NODE_OPEN:
+            solver(input_data, options, best_solution, &input_data->a_start, &input_data->b_start, NULL,
+                sumset_node_is_symmetric(&input_data->a_start, &input_data->b_start));
+            break;
+        case SUMSET_NODE_TERMINAL:
+            record_solution(input_data, options, best_solution, &input_data->a_start, &input_data->b_start);
+            break;
+        case SUMSET_NODE_DEAD:
+            break;
+        }
+        return;
+    }
+
+    while (resumed_next < resumed.branches_count && !stopped) {
+        const Branch* branch = &resumed.branches[resumed_next++];
+        Sumset* a_chain = (Sumset*) malloc((branch_side_size(&branch->a) + 2) * sizeof(Sumset));
+        Sumset* b_chain = (Sumset*) malloc((branch_side_size(&branch->b) + 2) * sizeof(Sumset));
+        const Sumset* a = branch_side_build(&branch->a, input_data, a_chain);
+        const Sumset* b = branch_side_build(&branch->b, input_data, b_chain);
+        solver(input_data, options, best_solution, a, b,
+            element_set_is_empty(&branch->children) ? NULL : &branch->children, false);
+        free(a_chain);
+        free(b_chain);
+    }
+}
+
+int solver_main(int argc, char* argv[], const TaskInput* task)
 {
+    Options options;
+    options_parse(&options, argc, argv);
+    options_check_implementation(&options, IMPLEMENTATION_NONRECURSIVE, argv[0]);
+    if (options.deadline) {
+        deadline_ns = stats_now_ns() + options.deadline * 1000000000ULL;
+    }
+
     InputData input_data;
-    input_data_read(&input_data);
+    input_data_load(&input_data, task);
     //input_data_init(&input_data, 8, 34, (int[]){0}, (int[]){1, 0});
 
     Solution best_solution;
     solution_init(&best_solution);
+    if (options.sweep) {
+        sweep_init(&sweep, &input_data);
+    }
+    stats_init(&stats);
+    if (options.cache_bytes) {
+        cache = cache_create(options.cache_bytes, input_data.d, options.cache_max_sum);
+    }
+
+    checkpoint_init(&resumed);
+    checkpoint_init(&left);
+    bool resuming = options.resume && checkpoint_read(&resumed, options.checkpoint_path, &input_data);
+    if (resuming) {
+        fprintf(stderr, "checkpoint: resuming %d branches from %s\n", resumed.branches_count, options.checkpoint_path);
+    } else if (options.resume) {
+        fprintf(stderr, "checkpoint: no checkpoint at %s, starting from scratch\n", options.checkpoint_path);
+    }
+    if (!resuming && options.shards) {
+        shard_split(&resumed, &input_data, options.shard, options.shards);
+        resuming = true;
+    }
+    if (resuming) {
+        best_solution = resumed.best;
+    }
+    if (options.estimate_probes) {
+        estimated_nodes = estimate_search(&input_data, &options, resuming ? &resumed : NULL);
+        if (options.progress_interval == 0) {
+            checkpoint_destroy(&resumed);
+            if (cache) {
+                cache_destroy(cache);
+            }
+            return 0;
+        }
+    }
+    start_ns = stats_now_ns();
+    if (options.checkpoint_path) {
+        checkpoint_due_ns = start_ns + options.checkpoint_interval * 1000000000ULL;
+    }
+    if (options.progress_interval) {
+        progress_due_ns = start_ns + options.progress_interval * 1000000000ULL;
+    }
+    clock_schedule();
+    check_target(&options, &best_solution);
+
+    if (!resuming || resumed.branches_count > 0) {
+        solve(&input_data, &options, &best_solution,
+            options.engine == ENGINE_POOL ? nonrecursive_pool_solv_no_pairs : frames_solv);
+    }
+
+    // The final checkpoint has what the deadline left of the search, or no branches, then resuming from it
+    // just prints the solution.
+    if (options.checkpoint_path && stopped) {
+        checkpoint_write(&left, options.checkpoint_path, &input_data);
+    } else if (options.checkpoint_path) {
+        Checkpoint done;
+        checkpoint_init(&done);
+        checkpoint_save(&input_data, &options, &best_solution, &done);
+        checkpoint_destroy(&done);
+    }
 
-    nonrecursive_pool_solv_no_pairs(&input_data, &best_solution);
+    stats.run_ns = stats_now_ns() - start_ns;
+    stats_add_run(&stats, &resumed.stats);
+    checkpoint_destroy(&resumed);
 
-    solution_print(&best_solution);
+    if (options.shards) {
+        shard_print_header(options.shard, options.shards, &input_data);
+    }
+    if (options.target) {
+        target_print(options.target, &best_solution, left.branches_count == 0, stats.nodes_expanded, stats.pruned);
+    } else if (options.sweep) {
+        sweep_print(&sweep);
+    } else {
+        solution_print(&best_solution);
+    }
+    // Stopped with nothing left (between the last node and the end), the search is complete all the same.
+    if (options.deadline && left.branches_count > 0) {
+        fprintf(stderr, "deadline: complete=no branches_left=%d upper_bound=%d\n", left.branches_count,
+            checkpoint_bound(&left, &input_data, options.bound ? options.bound : bound_pigeonhole));
+    } else if (options.deadline) {
+        fprintf(stderr, "deadline: complete=yes\n");
+    }
+    checkpoint_destroy(&left);
+    if (options.bound) {
+        fprintf(stderr, "branch-and-bound: pruned=%lu\n", stats.pruned);
+    }
+    if (cache) {
+        fprintf(stderr, "cache: hits=%lu misses=%lu\n", stats.cache_hits, stats.cache_misses);
+        cache_destroy(cache);
+    }
+    if (options.stats) {
+        stats_print(&stats, 1);
+    }
     return 0;
 }
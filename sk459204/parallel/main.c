@@ -1,21 +1,28 @@
 #include <stddef.h>
 
+#include "common/cache.h"
+#include "common/checkpoint.h"
+#include "common/estimate.h"
 #include "common/io.h"
+#include "common/options.h"
+#include "common/remote.h"
+#include "common/shard.h"
+#include "common/stats.h"
 #include "common/sumset.h"
+#include "common/worker_pool.h"
+#include "parallel/search.h"
 #include <common/err.h>
 
-#include <pthread.h>
-#include <stdatomic.h>
+#include <fcntl.h>
+#include <poll.h>
 
 #include <stdlib.h>
 #include <stdio.h>
-
-#define INITIAL_BRANCH_POOL_SIZE 8192
-#define INITIAL_SUMSET_POOL_SIZE 1024
+#include <unistd.h>
 
 // HELPER FUNCTIONS
 
-int max(int a, int b) {
+static int max(int a, int b) {
     if (a > b) {
         return a;
     } else {
@@ -23,329 +30,282 @@ int max(int a, int b) {
     }
 }
 
-void check_mem_alloc(void* ptr) {
-    if (ptr == NULL) exit(1);
-}
-
-// STRUCTS
-
-typedef struct SmartParallelSumset {
-    Sumset sumset;
-    struct SmartParallelSumset* parent;
-
-    atomic_int parent_to;
-
-    struct SmartParallelSumset* next_on_free_list;
-} SPS_t;
-
-typedef struct BranchPool {
-    SPS_t** stack;
-    int last_push_index;
-    int stack_size;
-
-    pthread_mutex_t mutex;
-
-    pthread_cond_t waiting_room;
-    int waiting_threads;
-
-    bool finish;
-} BranchPool_t;
-
-typedef struct SPSPool {
-    SPS_t* pool;
-    SPS_t* free_list;
-    int pool_size;
-
-    pthread_mutex_t mutex;
-} SPSPool_t;
-
-typedef struct ThreadResources {
-    BranchPool_t* branch_pool;
-    InputData* input;
-    Solution* mySolution;
-    SPSPool_t* sps_pool;
-} TR_t;
-
-// SPSPOOL FUNCTIONS
-
-SPSPool_t* sps_pool_init() {
-    SPSPool_t* sps_pool = (SPSPool_t*) malloc(sizeof(SPSPool_t));
-    check_mem_alloc(sps_pool);
-    sps_pool->pool = (SPS_t*) malloc(INITIAL_SUMSET_POOL_SIZE * sizeof(SPS_t));
-    check_mem_alloc(sps_pool->pool);
-    sps_pool->pool_size = INITIAL_SUMSET_POOL_SIZE;
-
-    for (int i = 0; i < sps_pool->pool_size - 1; ++i) {
-        sps_pool->pool[i].next_on_free_list = &sps_pool->pool[i + 1];
+// Prints the counters the options ask for to stderr.
+static void print_counters(const Options* options, const Stats* stats, int workers, const Cache* cache) {
+    if (options->bound) {
+        unsigned long pruned_nodes = 0;
+        for (int i = 0; i < workers; ++i) {
+            pruned_nodes += stats[i].pruned;
+        }
+        fprintf(stderr, "branch-and-bound: pruned=%lu\n", pruned_nodes);
     }
-    sps_pool->pool[sps_pool->pool_size - 1].next_on_free_list = NULL;
-
-    sps_pool->free_list = &sps_pool->pool[0];
-
-    ASSERT_ZERO(pthread_mutex_init(&sps_pool->mutex, NULL));
-
-    return sps_pool;
-}
-
-SPS_t* sps_pool_get(SPSPool_t* pool) {
-    ASSERT_ZERO(pthread_mutex_lock(&pool->mutex));
-    if (pool->free_list == NULL) {
-        pool->pool = (SPS_t*) realloc(pool->pool, 2 * pool->pool_size * sizeof(SPS_t));
-        check_mem_alloc(pool->pool);
-        pool->pool_size *= 2;
-        pool->free_list = &pool->pool[pool->pool_size / 2];
 
-        for (int i = pool->pool_size / 2; i < pool->pool_size - 1; ++i) {
-            pool->pool[i].next_on_free_list = &pool->pool[i + 1];
+    if (cache) {
+        unsigned long hits = 0;
+        unsigned long misses = 0;
+        for (int i = 0; i < workers; ++i) {
+            hits += stats[i].cache_hits;
+            misses += stats[i].cache_misses;
         }
-        pool->pool[pool->pool_size - 1].next_on_free_list = NULL;
+        fprintf(stderr, "cache: hits=%lu misses=%lu\n", hits, misses);
     }
 
-    SPS_t* to_return = pool->free_list;
-    pool->free_list = pool->free_list->next_on_free_list;
-    ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
-    return to_return;
-}
-
-void sps_pool_return(SPSPool_t* pool, SPS_t* returning) {
-    ASSERT_ZERO(pthread_mutex_lock(&pool->mutex));
-    returning->next_on_free_list = pool->free_list;
-    pool->free_list = returning;
-    ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
-}
-
-void sps_pool_destroy(SPSPool_t* pool) {
-    free(pool->pool);
-    ASSERT_ZERO(pthread_mutex_destroy(&pool->mutex));
-    free(pool);
+    if (options->stats) {
+        stats_print(stats, workers);
+    }
 }
 
-// BRANCH POOL FUNCTIONS
-
-BranchPool_t* branch_pool_init() {
-    BranchPool_t* pool = (BranchPool_t*) malloc(sizeof(BranchPool_t));
-    check_mem_alloc(pool);
+// REMOTE WORKER FUNCTIONS (see remote.h)
 
-    pool->stack = (SPS_t**) malloc(INITIAL_BRANCH_POOL_SIZE * sizeof(SPS_t*));
-    check_mem_alloc(pool->stack);
-    pool->last_push_index = -1;
-    pool->stack_size = INITIAL_BRANCH_POOL_SIZE;
-
-    ASSERT_ZERO(pthread_mutex_init(&pool->mutex, NULL));
-    
-    ASSERT_ZERO(pthread_cond_init(&pool->waiting_room, NULL));
-    pool->waiting_threads = 0;
-
-    pool->finish = false;
-
-    return pool;
+static void worker_send(Remote* remote, const InputData* input_data, const Message* message) {
+    if (!remote_send(remote, input_data, message)) {
+        fatal("the coordinator is gone");
+    }
 }
 
-void give_away_branch(BranchPool_t* pool, SPS_t* a, SPS_t* b) {
-    ASSERT_ZERO(pthread_mutex_lock(&pool->mutex));
-    pool->last_push_index += 2;
-    if (pool->last_push_index >= pool->stack_size) {
-        pool->stack = (SPS_t**) realloc(pool->stack, 2 * pool->stack_size * sizeof(SPS_t*));
-        check_mem_alloc(pool->stack);
-        pool->stack_size *= 2;
+// Stops the workers and sends the unexplored part of their branch back to the coordinator, which ends the run.
+static void worker_split(Search_t* search, Remote* remote, const InputData* input_data) {
+    Checkpoint frontier;
+    checkpoint_init(&frontier);
+    search_split(search, &frontier);
+
+    Message message;
+    message.kind = MESSAGE_BRANCH;
+    for (int i = 0; i < frontier.branches_count; ++i) {
+        message.branch = frontier.branches[i];
+        worker_send(remote, input_data, &message);
     }
-
-    pool->stack[pool->last_push_index - 1] = a;
-    pool->stack[pool->last_push_index] = b;
-    ASSERT_ZERO(pthread_cond_signal(&pool->waiting_room));
-    ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
+    checkpoint_destroy(&frontier);
 }
 
-void take_new_branch(BranchPool_t* pool, SPS_t** a, SPS_t** b, int workingThreads) {
-    ASSERT_ZERO(pthread_mutex_lock(&pool->mutex));
-
-    *a = NULL;
-    *b = NULL;
-
-    if (pool->last_push_index == -1 && pool->waiting_threads == workingThreads - 1) {
-        pool->finish = true;
-        ASSERT_ZERO(pthread_cond_broadcast(&pool->waiting_room));
-        ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
-        return;
-    } else if (pool->last_push_index == -1) {
-        while (pool->last_push_index == -1 && !pool->finish) {
-            pool->waiting_threads++;
-            ASSERT_ZERO(pthread_cond_wait(&pool->waiting_room, &pool->mutex));
-            pool->waiting_threads--;
+// Main thread of a worker while the threads explore a branch: passes better sums on both ways, and splits
+// the branch when the coordinator asks to. Returns once the run is over. `reported` is the best sum the
+// coordinator knows of.
+static void worker_serve(Search_t* search, Remote* remote, const InputData* input_data, int events_fd, int* reported) {
+    struct pollfd fds[2] = { { .fd = remote->fd, .events = POLLIN }, { .fd = events_fd, .events = POLLIN } };
+    Message message;
+    while (!search_finished(search)) {
+        int best = search_best_sum(search);
+        if (best > *reported) {
+            message.kind = MESSAGE_BOUND;
+            message.sum = best;
+            worker_send(remote, input_data, &message);
+            *reported = best;
         }
-    }
 
-    if (pool->last_push_index != -1) {
-        *b = pool->stack[pool->last_push_index];
-        *a = pool->stack[pool->last_push_index - 1];
-        pool->last_push_index -= 2;
+        ASSERT_SYS_OK(poll(fds, 2, -1));
+        if (fds[1].revents) {
+            char events[64];
+            while (read(events_fd, events, sizeof(events)) > 0) {
+            }
+        }
+        if (fds[0].revents) {
+            if (!remote_receive(remote)) {
+                fatal("the coordinator is gone");
+            }
+            while (remote_next(remote, input_data, &message)) {
+                if (message.kind == MESSAGE_BOUND) {
+                    search_raise_best_sum(search, message.sum);
+                    *reported = max(*reported, message.sum);
+                } else if (message.kind == MESSAGE_SPLIT) {
+                    worker_split(search, remote, input_data);
+                } else {
+                    fatal("unexpected message from the coordinator");
+                }
+            }
+        }
     }
-
-    ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
-}
-
-int branch_pool_size(BranchPool_t* pool) {
-    ASSERT_ZERO(pthread_mutex_lock(&pool->mutex));
-    int result = (pool->last_push_index + 1) / 2;
-    ASSERT_ZERO(pthread_mutex_unlock(&pool->mutex));
-    return result;
 }
 
-void branch_pool_destroy(BranchPool_t* pool) {
-    free(pool->stack);
-    ASSERT_ZERO(pthread_mutex_destroy(&pool->mutex));
-    ASSERT_ZERO(pthread_cond_destroy(&pool->waiting_room));
-    free(pool);
-}
-
-// SPS FUNCTIONS
-
-void swap(SPS_t** a, SPS_t** b) {
-    SPS_t* tmp = *a;
-    *a = *b;
-    *b = tmp;
-}
-
-void check_if_free(SPSPool_t* pool, SPS_t* a) {
-    if (atomic_fetch_sub(&a->parent_to, 1) == 1) {
-        SPS_t* parent_to_check = a->parent;
-        sps_pool_return(pool, a);
-        check_if_free(pool, parent_to_check);
-    }    
-}
-
-// THREAD WORK
-
-void branch_split(TR_t* resources, SPS_t* a, SPS_t* b) {
-    if (a->sumset.sum > b->sumset.sum) {
-        swap(&a, &b);
+// Explores the branches handed out by the coordinator at options->connect_path, one at a time with the input_data->t
+// threads of `pool`, until it says the search is over.
+static void worker_run(WorkerPool* pool, InputData* input_data, const Options* options, Cache* cache) {
+    Remote remote;
+    remote_connect(&remote, options->connect_path);
+    int events[2];
+    ASSERT_SYS_OK(pipe(events));
+    ASSERT_SYS_OK(fcntl(events[0], F_SETFL, O_NONBLOCK));
+    ASSERT_SYS_OK(fcntl(events[1], F_SETFL, O_NONBLOCK));
+
+    Message message;
+    message.kind = MESSAGE_HELLO;
+    worker_send(&remote, input_data, &message);
+
+    int workers = input_data->t;
+    Stats stats[workers]; // counters of all runs, per thread
+    for (int i = 0; i < workers; ++i) {
+        stats_init(&stats[i]);
     }
+    int best_sum = 0; // best sum found by anyone so far
+    int reported = 0; // best sum the coordinator knows of
 
-    if (is_sumset_intersection_trivial(&a->sumset, &b->sumset)) { // s(a) ∩ s(b) = {0}.
-        for (size_t i = a->sumset.last; i <= resources->input->d; ++i) {
-            if (!does_sumset_contain(&b->sumset, i)) {
-                SPS_t* a_with_i = sps_pool_get(resources->sps_pool);
-                a_with_i->parent = a;
-                atomic_store(&a_with_i->parent_to, 1);
-
-                sumset_add(&a_with_i->sumset, &a->sumset, i);
-
-                atomic_fetch_add(&a->parent_to, 1);
-                atomic_fetch_add(&b->parent_to, 1);
-                give_away_branch(resources->branch_pool, a_with_i, b);
+    while (true) {
+        if (!remote_next(&remote, input_data, &message)) {
+            if (!remote_receive(&remote)) {
+                fatal("the coordinator is gone");
             }
+            continue;
         }
-    } else if ((a->sumset.sum == b->sumset.sum) && (get_sumset_intersection_size(&a->sumset, &b->sumset) == 2)) { // s(a) ∩ s(b) = {0, ∑b}.
-        if (a->sumset.sum > resources->mySolution->sum) {
-            solution_build(resources->mySolution, resources->input, &a->sumset, &b->sumset);
+        if (message.kind == MESSAGE_QUIT) {
+            break;
         }
-    }
-
-    check_if_free(resources->sps_pool, a);
-    check_if_free(resources->sps_pool, b);
-}
-
-void recursive_solv(TR_t* resources, SPS_t* a, SPS_t* b) {
-    if (a->sumset.sum > b->sumset.sum) {
-        recursive_solv(resources, b, a);
-    } else {
-        if (is_sumset_intersection_trivial(&a->sumset, &b->sumset)) { // s(a) ∩ s(b) = {0}.
-            for (size_t i = a->sumset.last; i <= resources->input->d; ++i) {
-                if (!does_sumset_contain(&b->sumset, i)) {
-                    SPS_t a_with_i;
-                    a_with_i.parent = a;
-                    sumset_add(&a_with_i.sumset, &a->sumset, i);
-                    recursive_solv(resources, &a_with_i, b);
-                }
+        if (message.kind == MESSAGE_HELLO) {
+            if (!message.same_input) {
+                fatal("the coordinator at %s read a different input", options->connect_path);
             }
-        } else if ((a->sumset.sum == b->sumset.sum) && (get_sumset_intersection_size(&a->sumset, &b->sumset) == 2)) { // s(a) ∩ s(b) = {0, ∑b}.
-            if (b->sumset.sum > resources->mySolution->sum)
-                solution_build(resources->mySolution, resources->input, &a->sumset, &b->sumset);
-        }    
-    }
-}
-
-void* thread_calculations(void* args) {
-    TR_t* resources = (TR_t*) args;
-
-    SPS_t* a;
-    SPS_t* b;
-
-    take_new_branch(resources->branch_pool, &a, &b, resources->input->t);
+            continue;
+        }
+        if (message.kind == MESSAGE_BOUND) {
+            best_sum = max(best_sum, message.sum);
+            reported = max(reported, message.sum);
+            continue;
+        }
+        if (message.kind == MESSAGE_SPLIT) {
+            continue; // crossed the done message of the previous branch
+        }
+        if (message.kind != MESSAGE_BRANCH) {
+            fatal("unexpected message from the coordinator");
+        }
 
-    while (a != NULL && b != NULL) {
-        if (branch_pool_size(resources->branch_pool) < resources->input->t - 1) {
-            branch_split(resources, a, b);
-        } else {
-            recursive_solv(resources, a, b);
-            check_if_free(resources->sps_pool, a);
-            check_if_free(resources->sps_pool, b);
+        Checkpoint branches;
+        checkpoint_init(&branches);
+        checkpoint_add(&branches, &message.branch);
+        Search_t* search = search_start(pool, input_data, options, cache, &branches, best_sum, events[1]);
+        worker_serve(search, &remote, input_data, events[0], &reported);
+        search_join(search);
+
+        message.kind = MESSAGE_DONE;
+        message.solution = *search_best(search);
+        stats_init(&message.stats);
+        for (int i = 0; i < workers; ++i) {
+            stats_merge(&message.stats, search_stats(search, i));
+            stats_add_run(&stats[i], search_stats(search, i));
         }
+        best_sum = max(best_sum, search_best_sum(search));
+        reported = max(reported, message.solution.sum);
+        worker_send(&remote, input_data, &message);
 
-        take_new_branch(resources->branch_pool, &a, &b, resources->input->t);
+        search_destroy(search);
+        checkpoint_destroy(&branches);
     }
 
-    return NULL;
+    print_counters(options, stats, workers, cache);
+    ASSERT_SYS_OK(close(events[0]));
+    ASSERT_SYS_OK(close(events[1]));
+    remote_close(&remote);
 }
 
-int main()
+int solver_main(int argc, char* argv[], const TaskInput* task)
 {   
+    Options options;
+    options_parse(&options, argc, argv);
+    options_check_implementation(&options, IMPLEMENTATION_PARALLEL, argv[0]);
+    uint64_t deadline_ns = options.deadline ? stats_now_ns() + options.deadline * 1000000000ULL : UINT64_MAX;
+
     InputData input_data;
-    input_data_read(&input_data);
+    input_data_load(&input_data, task);
     //input_data_init(&input_data, 16, 34, (int[]){0}, (int[]){1, 0});
 
-    // create common stack and sps pool and put first branch on stack
-    BranchPool_t* common_branch_pool = branch_pool_init();
-    SPSPool_t* sps_pool = sps_pool_init();
-
-    SPS_t a;
-    a.sumset = input_data.a_start;
-    a.parent = NULL;
-    atomic_store(&a.parent_to, 7);
-
-    SPS_t b;
-    b.sumset = input_data.b_start;
-    b.parent = NULL;
-    atomic_store(&b.parent_to, 7);
+    Cache* cache = options.cache_bytes ? cache_create(options.cache_bytes, input_data.d, options.cache_max_sum) : NULL;
 
-    give_away_branch(common_branch_pool, &a, &b);
+    if (options.connect_path) {
+        WorkerPool* pool = worker_pool_create(input_data.t);
+        worker_run(pool, &input_data, &options, cache);
+        worker_pool_destroy(pool);
+        if (cache) {
+            cache_destroy(cache);
+        }
+        return 0;
+    }
 
-    // create starter packs for threads
-    Solution solutions[input_data.t];
-    TR_t starterPacks[input_data.t];
+    Checkpoint resumed;
+    checkpoint_init(&resumed);
+    bool resuming = options.resume && checkpoint_read(&resumed, options.checkpoint_path, &input_data);
+    if (resuming) {
+        fprintf(stderr, "checkpoint: resuming %d branches from %s\n", resumed.branches_count, options.checkpoint_path);
+    } else if (options.resume) {
+        fprintf(stderr, "checkpoint: no checkpoint at %s, starting from scratch\n", options.checkpoint_path);
+    }
+    if (!resuming && options.shards) {
+        shard_split(&resumed, &input_data, options.shard, options.shards);
+        resuming = true;
+    }
 
-    for (int i = 0; i < input_data.t; ++i) {
-        solution_init(&solutions[i]);
-        starterPacks[i].branch_pool = common_branch_pool;
-        starterPacks[i].input = &input_data;
-        starterPacks[i].mySolution = &solutions[i];
-        starterPacks[i].sps_pool = sps_pool;
+    double estimated_nodes = 0;
+    if (options.estimate_probes) {
+        estimated_nodes = estimate_search(&input_data, &options, resuming ? &resumed : NULL);
+        if (options.progress_interval == 0) {
+            checkpoint_destroy(&resumed);
+            if (cache) {
+                cache_destroy(cache);
+            }
+            return 0;
+        }
     }
 
-    // start threads work
-    pthread_t threads[input_data.t];
-    for (int i = 0; i < input_data.t; ++i) {
-        ASSERT_ZERO(pthread_create(&threads[i], NULL, thread_calculations, &starterPacks[i]));
+    // A target is reached by any solution better than target - 1.
+    int best_sum = resumed.best.sum > options.target - 1 ? resumed.best.sum : options.target - 1;
+    WorkerPool* pool = worker_pool_create(input_data.t);
+    Search_t* search = search_start(pool, &input_data, &options, cache, resuming ? &resumed : NULL, best_sum, -1);
+
+    Checkpoint left;
+    checkpoint_init(&left);
+    bool stopped = false;
+    if (options.checkpoint_path || options.progress_interval || options.deadline || options.target) {
+        stopped = search_timer_loop(search, &resumed, estimated_nodes, deadline_ns, &left);
     }
 
     // wait for the end of calculations
-    for (int i = 0; i < input_data.t; ++i) {
-        ASSERT_ZERO(pthread_join(threads[i], NULL));
+    search_join(search);
+    worker_pool_destroy(pool);
+
+    // The final checkpoint has what the deadline left of the search, or no branches, then resuming from it
+    // just prints the solution.
+    if (options.checkpoint_path && stopped) {
+        checkpoint_write(&left, options.checkpoint_path, &input_data);
+    } else if (options.checkpoint_path) {
+        search_checkpoint_save(search, &resumed);
     }
+    // Counters of earlier runs are reported as worker 0's.
+    stats_add_run(search_stats(search, 0), &resumed.stats);
+    checkpoint_destroy(&resumed);
 
-    // choose best solution
-    Solution* best_solution = &solutions[0];
-    for (int i = 1; i < input_data.t; ++i) {
-        if (solutions[i].sum > best_solution->sum) {
-            best_solution = &solutions[i];
+    if (options.shards) {
+        shard_print_header(options.shard, options.shards, &input_data);
+    }
+    if (options.target) {
+        unsigned long nodes = 0;
+        unsigned long pruned = 0;
+        for (int i = 0; i < input_data.t; ++i) {
+            nodes += search_stats(search, i)->nodes_expanded;
+            pruned += search_stats(search, i)->pruned;
         }
+        target_print(options.target, search_best(search), left.branches_count == 0, nodes, pruned);
+    } else if (options.sweep) {
+        sweep_print(search_sweep(search));
+    } else {
+        solution_print(search_best(search));
+    }
+    // Stopped with nothing left (between the last node and the end), the search is complete all the same.
+    if (options.deadline && left.branches_count > 0) {
+        fprintf(stderr, "deadline: complete=no branches_left=%d upper_bound=%d\n", left.branches_count,
+            checkpoint_bound(&left, &input_data, options.bound ? options.bound : bound_pigeonhole));
+    } else if (options.deadline) {
+        fprintf(stderr, "deadline: complete=yes\n");
     }
+    checkpoint_destroy(&left);
 
-    solution_print(best_solution);
+    Stats stats[input_data.t];
+    for (int i = 0; i < input_data.t; ++i) {
+        stats[i] = *search_stats(search, i);
+    }
+    print_counters(&options, stats, input_data.t, cache);
+    if (cache) {
+        cache_destroy(cache);
+    }
 
     // free allocated memory
-    branch_pool_destroy(common_branch_pool);
-    sps_pool_destroy(sps_pool);
+    search_destroy(search);
     
     return 0;
 }
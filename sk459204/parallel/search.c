@@ -0,0 +1,1418 @@
+#include "parallel/search.h"
+#include "common/estimate.h"
+#include "common/sumset.h"
+#include "common/sweep.h"
+#include <common/err.h>
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef SLAB_HUGE_PAGES
+#include <sys/mman.h>
+#endif
+
+#define INITIAL_BRANCH_DEQUE_SIZE 1024
+#define CACHE_LINE_SIZE 64
+#define STEAL_ROUNDS_BEFORE_PARKING 4
+#define SLAB_CHUNK_BYTES (2 * 1024 * 1024) // one transparent huge page
+#define SLAB_REMOTE_BATCH 64
+#define FRAME_CHUNK_SIZE 64
+#define QUIESCE_RETRY_NS 10000000 // how often the main thread repeats a checkpoint request
+#define PUBLISH_NODES 1024 // how often a worker publishes its count of expanded nodes, for progress reports (a power of 2)
+
+// HELPER FUNCTIONS
+
+static void check_mem_alloc(void* ptr) {
+    if (ptr == NULL) exit(1);
+}
+
+// STRUCTS
+
+// Nodes live in per-thread slabs and never move, so `parent` and `sumset.prev` pointers stay valid.
+// The sumset starts on its own cache line, so updates of parent_to don't false-share with it.
+typedef struct SmartParallelSumset {
+    alignas(CACHE_LINE_SIZE) atomic_int parent_to;
+    int owner; // id of the worker whose slab the node is returned to
+    int frame_depth; // depth of the frame whose child buffer this is, -1 for slab nodes
+
+    struct SmartParallelSumset* parent;
+    struct SmartParallelSumset* next_on_free_list;
+
+    alignas(CACHE_LINE_SIZE) Sumset sumset;
+} SPS_t;
+
+// One work-stealing deque of (a, b) branches per worker (Chase-Lev, see "Correct and Efficient
+// Work-Stealing for Weak Memory Models", Le et al.). The owner pushes and pops at the bottom,
+// thieves steal from the top. Each entry takes two consecutive slots (a and b).
+typedef struct DequeBuffer {
+    long capacity; // in entries, always a power of two
+    _Atomic(SPS_t*)* slots;
+    struct DequeBuffer* retired; // smaller buffer this one replaced, thieves may still be reading it
+} DequeBuffer_t;
+
+typedef struct BranchDeque {
+    alignas(CACHE_LINE_SIZE) atomic_long top;
+    alignas(CACHE_LINE_SIZE) atomic_long bottom;
+    _Atomic(DequeBuffer_t*) buffer;
+
+    // Set by thieves that found this deque empty, asks the owner to donate part of its DFS.
+    alignas(CACHE_LINE_SIZE) atomic_bool donate_request;
+} BranchDeque_t;
+
+typedef struct Scheduler {
+    BranchDeque_t* deques;
+    int workers;
+
+    // Number of branches pushed and not yet fully processed, the search is over when it drops to 0.
+    alignas(CACHE_LINE_SIZE) atomic_long pending;
+
+    // Idle workers park here instead of spinning; pushers only touch the mutex when sleepers > 0.
+    alignas(CACHE_LINE_SIZE) atomic_int sleepers;
+    atomic_bool finish;
+    pthread_mutex_t park_mutex;
+    pthread_cond_t park_cond;
+
+    // Checkpoints (see checkpoint.h): the main thread raises checkpoint_requested, and every worker stops
+    // where its frames and deque are consistent (see scheduler_quiesce) until the main thread lowers it.
+    atomic_bool checkpoint_requested;
+    int quiesced; // number of stopped workers, guarded by park_mutex
+    pthread_cond_t main_cond; // signaled when the last worker stops or the search finishes
+
+    // Write end of a pipe polled by the main thread of a remote worker (see worker_serve), -1 otherwise.
+    // Written when the search finishes or a better solution is found.
+    int events_fd;
+} Scheduler_t;
+
+struct SPSPool;
+
+// Per-thread cache of SPS_t nodes, carved out of chunks that are never reallocated.
+typedef struct SPSSlab {
+    struct SPSPool* pool;
+    int id;
+
+    SPS_t* free_list;
+    SPS_t* bump; // next never used node in the newest chunk
+    SPS_t* bump_end;
+
+    void** chunks;
+    int chunks_count;
+    int chunks_size;
+
+    // Nodes freed by this worker but owned by others, handed back SLAB_REMOTE_BATCH at a time.
+    SPS_t** outgoing;
+    int* outgoing_count;
+
+    // Batches returned by other workers (a stack of lists, each list ends with the previous head).
+    alignas(CACHE_LINE_SIZE) _Atomic(SPS_t*) remote_free;
+} SPSSlab_t;
+
+typedef struct SPSPool {
+    SPSSlab_t* slabs;
+    int workers;
+} SPSPool_t;
+
+// A node of the sequential DFS. The sides are either slab nodes or child buffers of shallower frames.
+typedef struct Frame {
+    SPS_t* a; // ∑a ≤ ∑b
+    SPS_t* b;
+    ElementSet children; // open children not visited nor donated yet
+    SPS_t* copy; // slab copy of `child` made for donations, or NULL
+    SPS_t child; // buffer for the child being visited, child.parent = a
+} Frame_t;
+
+// Frames are allocated in chunks that never move, since deeper frames point into shallower ones.
+typedef struct FrameStack {
+    Frame_t** chunks;
+    int chunks_count;
+    int chunks_size;
+} FrameStack_t;
+
+// One DFS of a worker (see Options.cursors). The child buffers of its frames are only pointed to by its deeper frames.
+typedef struct Cursor {
+    FrameStack_t* frames;
+    int depth; // deepest frame in use, -1 if the cursor has no branch
+    SPS_t* a; // the branch it explores, taken from a deque
+    SPS_t* b;
+} Cursor_t;
+
+struct Search;
+
+typedef struct ThreadResources {
+    struct Search* search;
+    Scheduler_t* scheduler;
+    int id; // index of this worker's deque in scheduler->deques
+    InputData* input;
+    const Options* options;
+    Solution* mySolution;
+    atomic_int* best_sum; // shared incumbent, the best ∑A found by any worker
+    Cache* cache; // shared transposition cache, or NULL
+    Stats stats; // this worker's counters, merged at exit
+    SPSSlab_t* sps_slab;
+    Cursor_t* cursors; // options->cursors of them
+    atomic_ulong nodes_published; // stats.nodes_expanded as of a while ago, read by the main thread for progress reports
+    Sweep* sweep; // this worker's best solutions for every d' if options->sweep, NULL otherwise
+    atomic_int* sweep_best; // shared, sweep_best[d'] is the best sum found by any worker for d'
+} TR_t;
+
+// SPS SLAB FUNCTIONS
+
+static SPSPool_t* sps_pool_init(int workers) {
+    SPSPool_t* sps_pool = (SPSPool_t*) malloc(sizeof(SPSPool_t));
+    check_mem_alloc(sps_pool);
+    sps_pool->slabs = (SPSSlab_t*) aligned_alloc(CACHE_LINE_SIZE, workers * sizeof(SPSSlab_t));
+    check_mem_alloc(sps_pool->slabs);
+    sps_pool->workers = workers;
+
+    for (int i = 0; i < workers; ++i) {
+        SPSSlab_t* slab = &sps_pool->slabs[i];
+        slab->pool = sps_pool;
+        slab->id = i;
+        slab->free_list = NULL;
+        slab->bump = NULL;
+        slab->bump_end = NULL;
+
+        slab->chunks_size = 16;
+        slab->chunks_count = 0;
+        slab->chunks = (void**) malloc(slab->chunks_size * sizeof(void*));
+        check_mem_alloc(slab->chunks);
+
+        slab->outgoing = (SPS_t**) calloc(workers, sizeof(SPS_t*));
+        check_mem_alloc(slab->outgoing);
+        slab->outgoing_count = (int*) calloc(workers, sizeof(int));
+        check_mem_alloc(slab->outgoing_count);
+
+        atomic_init(&slab->remote_free, NULL);
+    }
+
+    return sps_pool;
+}
+
+static void sps_slab_add_chunk(SPSSlab_t* slab) {
+#ifdef SLAB_HUGE_PAGES
+    void* chunk = aligned_alloc(SLAB_CHUNK_BYTES, SLAB_CHUNK_BYTES);
+    check_mem_alloc(chunk);
+    madvise(chunk, SLAB_CHUNK_BYTES, MADV_HUGEPAGE); // only a hint, failure is fine
+#else
+    void* chunk = aligned_alloc(CACHE_LINE_SIZE, SLAB_CHUNK_BYTES);
+    check_mem_alloc(chunk);
+#endif
+
+    if (slab->chunks_count == slab->chunks_size) {
+        slab->chunks_size *= 2;
+        slab->chunks = (void**) realloc(slab->chunks, slab->chunks_size * sizeof(void*));
+        check_mem_alloc(slab->chunks);
+    }
+    slab->chunks[slab->chunks_count++] = chunk;
+
+    slab->bump = (SPS_t*) chunk;
+    slab->bump_end = slab->bump + SLAB_CHUNK_BYTES / sizeof(SPS_t);
+}
+
+// Owner only.
+static SPS_t* sps_slab_get(SPSSlab_t* slab) {
+    if (slab->free_list == NULL) {
+        slab->free_list = atomic_exchange_explicit(&slab->remote_free, NULL, memory_order_acquire);
+    }
+
+    SPS_t* to_return = slab->free_list;
+    if (to_return != NULL) {
+        slab->free_list = to_return->next_on_free_list;
+        return to_return;
+    }
+
+    if (slab->bump == slab->bump_end) {
+        sps_slab_add_chunk(slab);
+    }
+    to_return = slab->bump++;
+    to_return->owner = slab->id;
+    to_return->frame_depth = -1;
+    return to_return;
+}
+
+// Hands a list of nodes (linked through next_on_free_list) back to their owning slab.
+static void sps_slab_push_remote(SPSSlab_t* owner, SPS_t* head, SPS_t* tail) {
+    SPS_t* old_head = atomic_load_explicit(&owner->remote_free, memory_order_relaxed);
+    do {
+        tail->next_on_free_list = old_head;
+    } while (!atomic_compare_exchange_weak_explicit(
+        &owner->remote_free, &old_head, head, memory_order_release, memory_order_relaxed));
+}
+
+// Called by the worker owning `slab`, the node may come from any slab.
+static void sps_slab_return(SPSSlab_t* slab, SPS_t* returning) {
+    if (returning->owner == slab->id) {
+        returning->next_on_free_list = slab->free_list;
+        slab->free_list = returning;
+        return;
+    }
+
+    int owner = returning->owner;
+    SPS_t* batch = slab->outgoing[owner];
+    if (batch == NULL) {
+        returning->next_on_free_list = NULL; // the first node of a batch is its tail
+    } else {
+        returning->next_on_free_list = batch;
+    }
+    slab->outgoing[owner] = returning;
+
+    if (++slab->outgoing_count[owner] == SLAB_REMOTE_BATCH) {
+        SPS_t* tail = returning;
+        while (tail->next_on_free_list != NULL) {
+            tail = tail->next_on_free_list;
+        }
+        sps_slab_push_remote(&slab->pool->slabs[owner], returning, tail);
+        slab->outgoing[owner] = NULL;
+        slab->outgoing_count[owner] = 0;
+    }
+}
+
+static void sps_pool_destroy(SPSPool_t* pool) {
+    for (int i = 0; i < pool->workers; ++i) {
+        SPSSlab_t* slab = &pool->slabs[i];
+        for (int j = 0; j < slab->chunks_count; ++j) {
+            free(slab->chunks[j]);
+        }
+        free(slab->chunks);
+        free(slab->outgoing);
+        free(slab->outgoing_count);
+    }
+    free(pool->slabs);
+    free(pool);
+}
+
+// FRAME STACK FUNCTIONS
+
+static FrameStack_t* frame_stack_init() {
+    FrameStack_t* frames = (FrameStack_t*) malloc(sizeof(FrameStack_t));
+    check_mem_alloc(frames);
+    frames->chunks_size = 16;
+    frames->chunks_count = 0;
+    frames->chunks = (Frame_t**) malloc(frames->chunks_size * sizeof(Frame_t*));
+    check_mem_alloc(frames->chunks);
+    return frames;
+}
+
+static void frame_stack_grow(FrameStack_t* frames, int chunk) {
+    while (chunk >= frames->chunks_count) {
+        if (frames->chunks_count == frames->chunks_size) {
+            frames->chunks_size *= 2;
+            frames->chunks = (Frame_t**) realloc(frames->chunks, frames->chunks_size * sizeof(Frame_t*));
+            check_mem_alloc(frames->chunks);
+        }
+        Frame_t* frame_chunk = (Frame_t*) aligned_alloc(CACHE_LINE_SIZE, FRAME_CHUNK_SIZE * sizeof(Frame_t));
+        check_mem_alloc(frame_chunk);
+        for (int i = 0; i < FRAME_CHUNK_SIZE; ++i) {
+            frame_chunk[i].copy = NULL;
+            frame_chunk[i].child.frame_depth = frames->chunks_count * FRAME_CHUNK_SIZE + i;
+        }
+        frames->chunks[frames->chunks_count++] = frame_chunk;
+    }
+}
+
+static inline Frame_t* frame_stack_at(FrameStack_t* frames, int depth) {
+    int chunk = depth / FRAME_CHUNK_SIZE;
+    if (__builtin_expect(chunk >= frames->chunks_count, 0)) {
+        frame_stack_grow(frames, chunk);
+    }
+    return &frames->chunks[chunk][depth % FRAME_CHUNK_SIZE];
+}
+
+static void frame_stack_destroy(FrameStack_t* frames) {
+    for (int i = 0; i < frames->chunks_count; ++i) {
+        free(frames->chunks[i]);
+    }
+    free(frames->chunks);
+    free(frames);
+}
+
+// BRANCH DEQUE FUNCTIONS
+
+static DequeBuffer_t* deque_buffer_init(long capacity, DequeBuffer_t* retired) {
+    DequeBuffer_t* buffer = (DequeBuffer_t*) malloc(sizeof(DequeBuffer_t));
+    check_mem_alloc(buffer);
+    buffer->slots = (_Atomic(SPS_t*)*) malloc(2 * capacity * sizeof(_Atomic(SPS_t*)));
+    check_mem_alloc(buffer->slots);
+    buffer->capacity = capacity;
+    buffer->retired = retired;
+    return buffer;
+}
+
+static void deque_init(BranchDeque_t* deque) {
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->buffer, deque_buffer_init(INITIAL_BRANCH_DEQUE_SIZE, NULL));
+    atomic_init(&deque->donate_request, false);
+}
+
+static void deque_destroy(BranchDeque_t* deque) {
+    DequeBuffer_t* buffer = atomic_load(&deque->buffer);
+    while (buffer != NULL) {
+        DequeBuffer_t* retired = buffer->retired;
+        free(buffer->slots);
+        free(buffer);
+        buffer = retired;
+    }
+}
+
+static inline void deque_buffer_put(DequeBuffer_t* buffer, long index, SPS_t* a, SPS_t* b) {
+    long slot = 2 * (index & (buffer->capacity - 1));
+    atomic_store_explicit(&buffer->slots[slot], a, memory_order_relaxed);
+    atomic_store_explicit(&buffer->slots[slot + 1], b, memory_order_relaxed);
+}
+
+static inline void deque_buffer_get(DequeBuffer_t* buffer, long index, SPS_t** a, SPS_t** b) {
+    long slot = 2 * (index & (buffer->capacity - 1));
+    *a = atomic_load_explicit(&buffer->slots[slot], memory_order_relaxed);
+    *b = atomic_load_explicit(&buffer->slots[slot + 1], memory_order_relaxed);
+}
+
+// Owner only.
+static DequeBuffer_t* deque_grow(BranchDeque_t* deque, DequeBuffer_t* buffer, long top, long bottom) {
+    DequeBuffer_t* grown = deque_buffer_init(2 * buffer->capacity, buffer);
+    for (long i = top; i < bottom; ++i) {
+        SPS_t* a;
+        SPS_t* b;
+        deque_buffer_get(buffer, i, &a, &b);
+        deque_buffer_put(grown, i, a, b);
+    }
+    atomic_store_explicit(&deque->buffer, grown, memory_order_release);
+    return grown;
+}
+
+// Owner only.
+static void deque_push(BranchDeque_t* deque, SPS_t* a, SPS_t* b) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    DequeBuffer_t* buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    if (bottom - top > buffer->capacity - 1) {
+        buffer = deque_grow(deque, buffer, top, bottom);
+    }
+    deque_buffer_put(buffer, bottom, a, b);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+}
+
+// Owner only. Returns false if the deque is empty.
+static bool deque_pop(BranchDeque_t* deque, SPS_t** a, SPS_t** b) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    DequeBuffer_t* buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    deque_buffer_get(buffer, bottom, a, b);
+    if (top == bottom) { // last entry, race against thieves for it
+        bool won = atomic_compare_exchange_strong_explicit(
+            &deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+// Any thread. Returns false if the deque was empty or another thread won the race for the top entry.
+static bool deque_steal(BranchDeque_t* deque, SPS_t** a, SPS_t** b) {
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (top >= bottom) {
+        return false;
+    }
+
+    DequeBuffer_t* buffer = atomic_load_explicit(&deque->buffer, memory_order_acquire);
+    deque_buffer_get(buffer, top, a, b);
+    return atomic_compare_exchange_strong_explicit(
+        &deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+// SCHEDULER FUNCTIONS
+
+static Scheduler_t* scheduler_init(int workers) {
+    Scheduler_t* scheduler = (Scheduler_t*) aligned_alloc(CACHE_LINE_SIZE, sizeof(Scheduler_t));
+    check_mem_alloc(scheduler);
+
+    scheduler->deques = (BranchDeque_t*) aligned_alloc(CACHE_LINE_SIZE, workers * sizeof(BranchDeque_t));
+    check_mem_alloc(scheduler->deques);
+    for (int i = 0; i < workers; ++i) {
+        deque_init(&scheduler->deques[i]);
+    }
+    scheduler->workers = workers;
+
+    atomic_init(&scheduler->pending, 0);
+    atomic_init(&scheduler->sleepers, 0);
+    atomic_init(&scheduler->finish, false);
+    ASSERT_ZERO(pthread_mutex_init(&scheduler->park_mutex, NULL));
+    ASSERT_ZERO(pthread_cond_init(&scheduler->park_cond, NULL));
+    atomic_init(&scheduler->checkpoint_requested, false);
+    scheduler->quiesced = 0;
+    ASSERT_ZERO(pthread_cond_init(&scheduler->main_cond, NULL));
+    scheduler->events_fd = -1;
+
+    return scheduler;
+}
+
+static void scheduler_destroy(Scheduler_t* scheduler) {
+    for (int i = 0; i < scheduler->workers; ++i) {
+        deque_destroy(&scheduler->deques[i]);
+    }
+    free(scheduler->deques);
+    ASSERT_ZERO(pthread_mutex_destroy(&scheduler->park_mutex));
+    ASSERT_ZERO(pthread_cond_destroy(&scheduler->park_cond));
+    ASSERT_ZERO(pthread_cond_destroy(&scheduler->main_cond));
+    free(scheduler);
+}
+
+// Locks park_mutex, accounting the time spent waiting for it.
+static void scheduler_lock(Scheduler_t* scheduler, Stats* stats) {
+    uint64_t start = stats_now_ns();
+    ASSERT_ZERO(pthread_mutex_lock(&scheduler->park_mutex));
+    stats->lock_wait_ns += stats_now_ns() - start;
+}
+
+// Wakes parked workers after new branches were pushed. Called once per batch of pushes.
+static void scheduler_notify(Scheduler_t* scheduler, Stats* stats) {
+    // Pairs with the increment of sleepers in scheduler_park: either we see the sleeper,
+    // or the sleeper sees our pushes before it waits.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&scheduler->sleepers, memory_order_relaxed) > 0) {
+        scheduler_lock(scheduler, stats);
+        ASSERT_ZERO(pthread_cond_broadcast(&scheduler->park_cond));
+        ASSERT_ZERO(pthread_mutex_unlock(&scheduler->park_mutex));
+    }
+}
+
+// Wakes the main thread of a remote worker, if this is one.
+static void scheduler_event(Scheduler_t* scheduler) {
+    if (scheduler->events_fd >= 0) {
+        char event = 0;
+        // The pipe doesn't block: if it's full, the main thread has a wakeup pending anyway.
+        (void) !write(scheduler->events_fd, &event, 1);
+    }
+}
+
+// Wakes the main thread of a local search (see timer_loop).
+static void scheduler_wake_main(Scheduler_t* scheduler) {
+    ASSERT_ZERO(pthread_mutex_lock(&scheduler->park_mutex));
+    ASSERT_ZERO(pthread_cond_broadcast(&scheduler->main_cond));
+    ASSERT_ZERO(pthread_mutex_unlock(&scheduler->park_mutex));
+}
+
+// Asks every worker to stop where its frames and deque are consistent (see scheduler_quiesce), through their donate
+// requests, which they poll at every node. Only the main thread lets them go on (see scheduler_restart).
+static void scheduler_request_stop(Scheduler_t* scheduler) {
+    atomic_store(&scheduler->checkpoint_requested, true);
+    for (int i = 0; i < scheduler->workers; ++i) {
+        atomic_store(&scheduler->deques[i].donate_request, true);
+    }
+}
+
+static bool scheduler_has_work(Scheduler_t* scheduler) {
+    for (int i = 0; i < scheduler->workers; ++i) {
+        BranchDeque_t* deque = &scheduler->deques[i];
+        if (atomic_load(&deque->bottom) > atomic_load(&deque->top)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Owner of deques[id] only. Makes a new branch visible to thieves.
+static void give_away_branch(Scheduler_t* scheduler, int id, SPS_t* a, SPS_t* b) {
+    atomic_fetch_add_explicit(&scheduler->pending, 1, memory_order_relaxed);
+    deque_push(&scheduler->deques[id], a, b);
+}
+
+// Marks a branch taken with take_new_branch as fully processed (all its children already given away).
+static void branch_done(Scheduler_t* scheduler, Stats* stats) {
+    if (atomic_fetch_sub_explicit(&scheduler->pending, 1, memory_order_acq_rel) == 1) {
+        scheduler_lock(scheduler, stats);
+        atomic_store(&scheduler->finish, true);
+        ASSERT_ZERO(pthread_cond_broadcast(&scheduler->park_cond));
+        ASSERT_ZERO(pthread_cond_signal(&scheduler->main_cond));
+        ASSERT_ZERO(pthread_mutex_unlock(&scheduler->park_mutex));
+        scheduler_event(scheduler);
+    }
+}
+
+// Called by a worker while the main thread wants a checkpoint, at a point where its deque and the frames of its
+// cursors (up to their depths) are consistent. Waits until the checkpoint is written, or the search is stopped
+// (see scheduler_restart).
+static void scheduler_quiesce(Scheduler_t* scheduler, Stats* stats) {
+    scheduler_lock(scheduler, stats);
+    if (++scheduler->quiesced == scheduler->workers) {
+        ASSERT_ZERO(pthread_cond_signal(&scheduler->main_cond));
+    }
+    while (atomic_load(&scheduler->checkpoint_requested)) {
+        ASSERT_ZERO(pthread_cond_wait(&scheduler->park_cond, &scheduler->park_mutex));
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&scheduler->park_mutex));
+}
+
+static void scheduler_park(Scheduler_t* scheduler, Stats* stats) {
+    scheduler_lock(scheduler, stats);
+    atomic_fetch_add(&scheduler->sleepers, 1);
+    while (!atomic_load(&scheduler->finish) && !scheduler_has_work(scheduler)
+        && !atomic_load(&scheduler->checkpoint_requested)) {
+        ASSERT_ZERO(pthread_cond_wait(&scheduler->park_cond, &scheduler->park_mutex));
+    }
+    atomic_fetch_sub(&scheduler->sleepers, 1);
+    ASSERT_ZERO(pthread_mutex_unlock(&scheduler->park_mutex));
+}
+
+// Pops a branch from the worker's own deque, or steals one from the other workers.
+// Returns false once the whole search is finished.
+static bool take_new_branch(Scheduler_t* scheduler, int id, SPS_t** a, SPS_t** b, Stats* stats) {
+    if (deque_pop(&scheduler->deques[id], a, b)) {
+        return true;
+    }
+
+    while (!atomic_load_explicit(&scheduler->finish, memory_order_acquire)) {
+        if (atomic_load(&scheduler->checkpoint_requested)) {
+            scheduler_quiesce(scheduler, stats);
+            continue; // the search may have been stopped meanwhile
+        }
+        for (int round = 0; round < STEAL_ROUNDS_BEFORE_PARKING; ++round) {
+            for (int i = 1; i < scheduler->workers; ++i) {
+                BranchDeque_t* victim = &scheduler->deques[(id + i) % scheduler->workers];
+                if (deque_steal(victim, a, b)) {
+                    return true;
+                }
+                if (!atomic_load_explicit(&victim->donate_request, memory_order_relaxed)) {
+                    atomic_store_explicit(&victim->donate_request, true, memory_order_relaxed);
+                }
+            }
+        }
+        scheduler_park(scheduler, stats);
+    }
+
+    *a = NULL;
+    *b = NULL;
+    return false;
+}
+
+// SPS FUNCTIONS
+
+static void swap(SPS_t** a, SPS_t** b) {
+    SPS_t* tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static void check_if_free(SPSSlab_t* slab, SPS_t* a) {
+    if (atomic_fetch_sub(&a->parent_to, 1) == 1) {
+        SPS_t* parent_to_check = a->parent;
+        sps_slab_return(slab, a);
+        check_if_free(slab, parent_to_check);
+    }    
+}
+
+// BRANCH AND BOUND FUNCTIONS
+
+static void publish_solution(TR_t* resources, const Sumset* a, const Sumset* b) {
+    solution_build(resources->mySolution, resources->input, a, b);
+
+    int sum = resources->mySolution->sum;
+    int best = atomic_load_explicit(resources->best_sum, memory_order_relaxed);
+    while (sum > best && !atomic_compare_exchange_weak_explicit(
+        resources->best_sum, &best, sum, memory_order_relaxed, memory_order_relaxed)) {
+    }
+    if (sum > best) {
+        scheduler_event(resources->scheduler);
+        // The workers stop at once rather than when the main thread gets to stop them.
+        if (resources->options->target && sum >= resources->options->target) {
+            scheduler_request_stop(resources->scheduler);
+            scheduler_wake_main(resources->scheduler);
+        }
+    }
+}
+
+// Whether a solution reaching the target (see Options) was found.
+static bool target_reached(TR_t* resources) {
+    int target = resources->options->target;
+    return target && atomic_load(resources->best_sum) >= target;
+}
+
+// Records the pair (a, b) in this worker's sweep, and raises the shared best sums it beats.
+static void sweep_publish(TR_t* resources, const Sumset* a, const Sumset* b) {
+    Sweep* sweep = resources->sweep;
+    int from = sweep_record(sweep, resources->input, a, b);
+    for (int d = from; from > 0 && d <= sweep->d; ++d) {
+        int best = atomic_load_explicit(&resources->sweep_best[d], memory_order_relaxed);
+        while (sweep->best[d].sum > best && !atomic_compare_exchange_weak_explicit(
+            &resources->sweep_best[d], &best, sweep->best[d].sum, memory_order_relaxed, memory_order_relaxed)) {
+        }
+    }
+}
+
+static void record_solution(TR_t* resources, const Sumset* a, const Sumset* b) {
+    resources->stats.terminal_checks++;
+    if (resources->sweep != NULL) {
+        sweep_publish(resources, a, b);
+    } else if (a->sum > resources->mySolution->sum) {
+        publish_solution(resources, a, b);
+    }
+}
+
+// Whether the node (a, b) can't beat the best sum found by any worker for any d' whose tree has it (see sweep.h).
+static bool sweep_is_pruned_shared(TR_t* resources, const Sumset* a, const Sumset* b) {
+    const Sweep* sweep = resources->sweep;
+    int from = sweep_largest(sweep, a, b);
+    if (from < sweep->from) {
+        from = sweep->from;
+    }
+    for (int d = sweep->d; d >= from; --d) {
+        if (resources->options->bound(a, b, d) > atomic_load_explicit(&resources->sweep_best[d], memory_order_relaxed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether the node (a, b) can't beat the best sum found so far by any worker.
+static bool is_pruned(TR_t* resources, const SPS_t* a, const SPS_t* b) {
+    if (resources->options->bound == NULL) {
+        return false;
+    }
+    if (resources->sweep != NULL) {
+        if (!sweep_is_pruned_shared(resources, &a->sumset, &b->sumset)) {
+            return false;
+        }
+        resources->stats.pruned++;
+        return true;
+    }
+    int best = atomic_load_explicit(resources->best_sum, memory_order_relaxed);
+    if (resources->options->bound(&a->sumset, &b->sumset, resources->input->d) > best) {
+        return false;
+    }
+    resources->stats.pruned++;
+    return true;
+}
+
+// Whether the node (a, b), or one dominating it, was already visited through another path (by any worker).
+static bool is_cached(TR_t* resources, const SPS_t* a, const SPS_t* b) {
+    if (resources->cache == NULL || !cache_covers(resources->cache, &b->sumset)) {
+        return false;
+    }
+    if (cache_visit(resources->cache, &a->sumset, &b->sumset)) {
+        resources->stats.cache_hits++;
+        return true;
+    }
+    resources->stats.cache_misses++;
+    return false;
+}
+
+// THREAD WORK
+
+// Returns a slab node with the sumset of `node`, copying it (and its ancestors) out of the buffers of `frames`
+// first if needed. The copy stays cached in its frame until the buffer is reused.
+static SPS_t* frame_materialize(TR_t* resources, FrameStack_t* frames, SPS_t* node) {
+    if (node->frame_depth < 0) {
+        return node;
+    }
+
+    Frame_t* frame = frame_stack_at(frames, node->frame_depth);
+    if (frame->copy == NULL) {
+        SPS_t* parent = frame_materialize(resources, frames, node->parent);
+        SPS_t* copy = sps_slab_get(resources->sps_slab);
+        resources->stats.pool_allocs++;
+        sumset_copy(&copy->sumset, &node->sumset);
+        copy->sumset.prev = &parent->sumset;
+        copy->parent = parent;
+        atomic_store(&copy->parent_to, 1); // held by the frame
+        atomic_fetch_add(&parent->parent_to, 1);
+        frame->copy = copy;
+    }
+    return frame->copy;
+}
+
+// Called before the frame's child buffer is overwritten or abandoned.
+static void frame_release_copy(TR_t* resources, Frame_t* frame) {
+    if (frame->copy != NULL) {
+        check_if_free(resources->sps_slab, frame->copy);
+        frame->copy = NULL;
+    }
+}
+
+// Sets up the frame of the open node (a, b) (with s(a) ∩ s(b) = {0}): records its terminal
+// children right away and leaves the open ones to visit.
+static void frame_enter(TR_t* resources, Frame_t* frame, SPS_t* a, SPS_t* b) {
+    if (a->sumset.sum > b->sumset.sum) {
+        swap(&a, &b);
+    }
+    frame->a = a;
+    frame->b = b;
+
+    if (is_pruned(resources, a, b) || is_cached(resources, a, b)) {
+        for (int i = 0; i < ELEMENT_SET_WORDS; ++i) {
+            frame->children.bits[i] = 0;
+        }
+        return;
+    }
+
+    SumsetChildren children;
+    sumset_expand(&a->sumset, &b->sumset, resources->input->d, &children);
+    resources->stats.nodes_expanded++;
+    if ((resources->stats.nodes_expanded & (PUBLISH_NODES - 1)) == 0) {
+        atomic_store_explicit(&resources->nodes_published, resources->stats.nodes_expanded, memory_order_relaxed);
+    }
+    resources->stats.children_generated += element_set_size(&children.all);
+    resources->stats.children_rejected += children.rejected;
+    while (!element_set_is_empty(&children.terminal)) { // s(a_with_i) ∩ s(b) = {0, ∑b}.
+        Sumset a_with_i;
+        sumset_add(&a_with_i, &a->sumset, element_set_pop_min(&children.terminal));
+        record_solution(resources, &a_with_i, &b->sumset);
+    }
+    frame->children = children.open;
+}
+
+// Gives the larger half of the unvisited children of the shallowest frame (of all cursors) that has any to thieves,
+// so a stolen branch is always one of the biggest subtrees this worker still has.
+static void donate_siblings(TR_t* resources) {
+    Cursor_t* donor = NULL;
+    Frame_t* frame = NULL;
+    int shallowest = 0;
+    for (int c = 0; c < resources->options->cursors; ++c) {
+        Cursor_t* cursor = &resources->cursors[c];
+        for (int k = 0; k <= cursor->depth && (donor == NULL || k < shallowest); ++k) {
+            Frame_t* candidate = frame_stack_at(cursor->frames, k);
+            if (!element_set_is_empty(&candidate->children)) {
+                donor = cursor;
+                frame = candidate;
+                shallowest = k;
+                break;
+            }
+        }
+    }
+    if (donor == NULL) {
+        return;
+    }
+
+    int size = element_set_size(&frame->children);
+    ElementSet donated;
+    if (resources->options->larger_first) {
+        // Visited from the largest element (see cursor_step), the smallest ones are the ones it'd get to last.
+        ElementSet kept;
+        element_set_split(&frame->children, (size + 1) / 2, &kept);
+        donated = frame->children;
+        frame->children = kept;
+    } else {
+        element_set_split(&frame->children, size / 2, &donated);
+    }
+    SPS_t* a = frame_materialize(resources, donor->frames, frame->a);
+    SPS_t* b = frame_materialize(resources, donor->frames, frame->b);
+    while (!element_set_is_empty(&donated)) {
+        SPS_t* a_with_i = sps_slab_get(resources->sps_slab);
+        resources->stats.pool_allocs++;
+        a_with_i->parent = a;
+        atomic_store(&a_with_i->parent_to, 1);
+
+        sumset_add(&a_with_i->sumset, &a->sumset, element_set_pop_min(&donated));
+
+        atomic_fetch_add(&a->parent_to, 1);
+        atomic_fetch_add(&b->parent_to, 1);
+        give_away_branch(resources->scheduler, resources->id, a_with_i, b);
+        resources->stats.branches_given++;
+    }
+    scheduler_notify(resources->scheduler, &resources->stats);
+}
+
+// Hints the CPU to bring in the sides of the node the cursor visits next.
+static void cursor_prefetch(Cursor_t* cursor) {
+    if (cursor->depth >= 0) {
+        Frame_t* frame = frame_stack_at(cursor->frames, cursor->depth);
+        sumset_prefetch(&frame->a->sumset);
+        sumset_prefetch(&frame->b->sumset);
+    }
+}
+
+// Advances the cursor's DFS (see thread_calculations) by one node: expands the next unvisited child of its deepest
+// frame that has any, in a new frame. Children are visited from the smallest element added, or from the largest one
+// (see Options.larger_first). Leaves the depth at -1 once the branch is done.
+static void cursor_step(TR_t* resources, Cursor_t* cursor) {
+    int depth = cursor->depth;
+    Frame_t* frame = frame_stack_at(cursor->frames, depth);
+    frame_release_copy(resources, frame);
+    while (element_set_is_empty(&frame->children) && --depth >= 0) {
+        frame = frame_stack_at(cursor->frames, depth);
+        frame_release_copy(resources, frame);
+    }
+    if (depth < 0) {
+        cursor->depth = -1;
+        return;
+    }
+
+    int i = resources->options->larger_first ? element_set_pop_max(&frame->children)
+                                         : element_set_pop_min(&frame->children);
+    sumset_add(&frame->child.sumset, &frame->a->sumset, i);
+    frame->child.parent = frame->a;
+    cursor->depth = depth + 1;
+    frame_enter(resources, frame_stack_at(cursor->frames, depth + 1), &frame->child, frame->b);
+}
+
+// Expands a symmetric root (see sumset_node_is_symmetric) before the workers start:
+// every open child becomes a branch with its own copy of b, with last raised to the added element.
+static void root_split_symmetric(TR_t* resources, SPS_t* a, SPS_t* b) {
+    if (is_pruned(resources, a, b)) {
+        return;
+    }
+
+    SumsetChildren children;
+    sumset_expand(&a->sumset, &b->sumset, resources->input->d, &children);
+    resources->stats.nodes_expanded++;
+    resources->stats.children_generated += element_set_size(&children.all);
+    resources->stats.children_rejected += children.rejected;
+    while (!element_set_is_empty(&children.terminal)) { // s(a_with_i) ∩ s(b) = {0, ∑b}.
+        Sumset a_with_i;
+        sumset_add(&a_with_i, &a->sumset, element_set_pop_min(&children.terminal));
+        record_solution(resources, &a_with_i, &b->sumset);
+    }
+
+    while (!element_set_is_empty(&children.open)) {
+        int i = element_set_pop_min(&children.open);
+
+        SPS_t* a_with_i = sps_slab_get(resources->sps_slab);
+        a_with_i->parent = a;
+        atomic_store(&a_with_i->parent_to, 1);
+        sumset_add(&a_with_i->sumset, &a->sumset, i);
+
+        SPS_t* b_from_i = sps_slab_get(resources->sps_slab);
+        b_from_i->parent = b;
+        atomic_store(&b_from_i->parent_to, 1);
+        sumset_copy(&b_from_i->sumset, &b->sumset);
+        b_from_i->sumset.last = i;
+        resources->stats.pool_allocs += 2;
+
+        atomic_fetch_add(&a->parent_to, 1);
+        atomic_fetch_add(&b->parent_to, 1);
+        give_away_branch(resources->scheduler, resources->id, a_with_i, b_from_i);
+        resources->stats.branches_given++;
+    }
+}
+
+// Expands the branches of this worker's deque, and the ones it steals, one frame per level. Its cursors (see
+// Options.cursors) take turns, one node each, and the sides of the next cursor's node are prefetched while the current
+// one's is expanded. A cursor that finished its branch pops the next one from the deque; if that's empty while other
+// cursors still have nodes, their unvisited siblings are donated to it first. Only once all cursors are done does
+// the worker steal from the others, or park. Unvisited siblings are also handed out whenever a thief asks for work.
+static void thread_calculations(TR_t* resources) {
+    Stats* stats = &resources->stats;
+    Scheduler_t* scheduler = resources->scheduler;
+    BranchDeque_t* deque = &scheduler->deques[resources->id];
+    int count = resources->options->cursors;
+    uint64_t start = stats_now_ns();
+    for (int c = 0; c < count; ++c) {
+        resources->cursors[c].frames = frame_stack_init();
+    }
+
+    int active = 0; // cursors with a branch
+    for (int c = 0; true; c = c + 1 < count ? c + 1 : 0) {
+        Cursor_t* cursor = &resources->cursors[c];
+        if (cursor->depth < 0) {
+            SPS_t* a;
+            SPS_t* b;
+            if (active == 0) {
+                uint64_t idle_start = stats_now_ns();
+                bool taken = take_new_branch(scheduler, resources->id, &a, &b, stats);
+                stats->idle_ns += stats_now_ns() - idle_start;
+                if (!taken) {
+                    break;
+                }
+            } else if (!deque_pop(deque, &a, &b)) {
+                donate_siblings(resources);
+                if (!deque_pop(deque, &a, &b)) {
+                    continue;
+                }
+            }
+            stats->branches_taken++;
+            cursor->a = a;
+            cursor->b = b;
+            frame_enter(resources, frame_stack_at(cursor->frames, 0), a, b);
+            cursor->depth = 0;
+            active++;
+        }
+
+        if (atomic_load_explicit(&deque->donate_request, memory_order_relaxed)) {
+            atomic_store_explicit(&deque->donate_request, false, memory_order_relaxed);
+            if (atomic_load(&scheduler->checkpoint_requested)) {
+                scheduler_quiesce(scheduler, stats);
+                if (atomic_load(&scheduler->finish)) {
+                    break; // stopped, the frames were handed over
+                }
+            } else {
+                donate_siblings(resources);
+            }
+        }
+
+        if (count > 1) {
+            cursor_prefetch(&resources->cursors[c + 1 < count ? c + 1 : 0]);
+        }
+        cursor_step(resources, cursor);
+        if (cursor->depth >= 0) {
+            continue;
+        }
+
+        active--;
+        check_if_free(resources->sps_slab, cursor->a);
+        check_if_free(resources->sps_slab, cursor->b);
+        branch_done(scheduler, stats);
+        if (atomic_load_explicit(&scheduler->finish, memory_order_relaxed)) {
+            break; // stopped (see scheduler_restart), the deque was handed over with the frames
+        }
+    }
+
+    for (int c = 0; c < count; ++c) {
+        frame_stack_destroy(resources->cursors[c].frames);
+    }
+    stats->run_ns = stats_now_ns() - start;
+}
+
+// CHECKPOINT FUNCTIONS
+
+// Rebuilds a side of a resumed branch as a chain of slab nodes hanging off `start` (a or b of the start node).
+static SPS_t* branch_side_build_sps(TR_t* resources, const BranchSide* side, SPS_t* start) {
+    SPS_t* node = start;
+    for (int x = 1; x <= resources->input->d; ++x) {
+        for (int k = 0; k < side->added.count[x]; ++k) {
+            SPS_t* child = sps_slab_get(resources->sps_slab);
+            resources->stats.pool_allocs++;
+            child->parent = node;
+            atomic_store(&child->parent_to, 0);
+            sumset_add(&child->sumset, &node->sumset, x);
+            atomic_fetch_add(&node->parent_to, 1);
+            node = child;
+        }
+    }
+    if (node->sumset.last != side->last) {
+        SPS_t* copy = sps_slab_get(resources->sps_slab);
+        resources->stats.pool_allocs++;
+        copy->parent = node;
+        atomic_store(&copy->parent_to, 0);
+        sumset_copy(&copy->sumset, &node->sumset);
+        copy->sumset.last = side->last;
+        atomic_fetch_add(&node->parent_to, 1);
+        node = copy;
+    }
+    return node;
+}
+
+// Gives away a branch of the resumed checkpoint, before the workers start.
+static void resume_branch(TR_t* resources, const Branch* branch, SPS_t* a_start, SPS_t* b_start) {
+    SPS_t* a = branch_side_build_sps(resources, &branch->a, branch->a.from_b ? b_start : a_start);
+    SPS_t* b = branch_side_build_sps(resources, &branch->b, branch->b.from_b ? b_start : a_start);
+    if (element_set_is_empty(&branch->children)) {
+        atomic_fetch_add(&a->parent_to, 1);
+        atomic_fetch_add(&b->parent_to, 1);
+        give_away_branch(resources->scheduler, resources->id, a, b);
+        resources->stats.branches_given++;
+        return;
+    }
+
+    ElementSet children = branch->children;
+    while (!element_set_is_empty(&children)) {
+        SPS_t* a_with_i = sps_slab_get(resources->sps_slab);
+        resources->stats.pool_allocs++;
+        a_with_i->parent = a;
+        atomic_store(&a_with_i->parent_to, 1);
+        sumset_add(&a_with_i->sumset, &a->sumset, element_set_pop_min(&children));
+
+        atomic_fetch_add(&a->parent_to, 1);
+        atomic_fetch_add(&b->parent_to, 1);
+        give_away_branch(resources->scheduler, resources->id, a_with_i, b);
+        resources->stats.branches_given++;
+    }
+}
+
+// Adds the frontier of a stopped worker: the unvisited children of the frames of each of its cursors, deepest first,
+// then its deque from the bottom (in the order the worker would get to them).
+static void checkpoint_add_worker(Checkpoint* checkpoint, TR_t* resources) {
+    Branch branch;
+    for (int c = 0; c < resources->options->cursors; ++c) {
+        Cursor_t* cursor = &resources->cursors[c];
+        for (int k = cursor->depth; k >= 0; --k) {
+            Frame_t* frame = frame_stack_at(cursor->frames, k);
+            if (!element_set_is_empty(&frame->children)) {
+                branch_init(&branch, resources->input, &frame->a->sumset, &frame->b->sumset, &frame->children);
+                checkpoint_add(checkpoint, &branch);
+            }
+        }
+    }
+
+    BranchDeque_t* deque = &resources->scheduler->deques[resources->id];
+    DequeBuffer_t* buffer = atomic_load(&deque->buffer);
+    for (long i = atomic_load(&deque->bottom) - 1; i >= atomic_load(&deque->top); --i) {
+        SPS_t* a;
+        SPS_t* b;
+        deque_buffer_get(buffer, i, &a, &b);
+        branch_init(&branch, resources->input, &a->sumset, &b->sumset, NULL);
+        checkpoint_add(checkpoint, &branch);
+    }
+}
+
+// Sets the empty `checkpoint` to the best solution of all workers, their counters added to the ones of earlier runs,
+// and their frontiers (all workers must be stopped), or no frontier at all once the search is over.
+static void checkpoint_collect(Checkpoint* checkpoint, TR_t* resources, int workers, const Checkpoint* resumed,
+    uint64_t start_ns, bool over) {
+    for (int i = 0; i < workers; ++i) {
+        if (!over) {
+            checkpoint_add_worker(checkpoint, &resources[i]);
+        }
+        if (resources[i].mySolution->sum > checkpoint->best.sum) {
+            checkpoint->best = *resources[i].mySolution;
+        }
+        stats_merge(&checkpoint->stats, &resources[i].stats);
+    }
+    checkpoint->stats.run_ns = stats_now_ns() - start_ns;
+    stats_add_run(&checkpoint->stats, &resumed->stats);
+}
+
+// Writes a checkpoint collected as above.
+static void checkpoint_save(TR_t* resources, int workers, const Checkpoint* resumed, uint64_t start_ns, bool over) {
+    Checkpoint checkpoint;
+    checkpoint_init(&checkpoint);
+    checkpoint_collect(&checkpoint, resources, workers, resumed, start_ns, over);
+    checkpoint_write(&checkpoint, resources->options->checkpoint_path, resources->input);
+    checkpoint_destroy(&checkpoint);
+}
+
+
+// Deadlines for pthread_cond_timedwait (on CLOCK_REALTIME).
+static struct timespec deadline_after(uint64_t ns) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    ns += deadline.tv_nsec;
+    deadline.tv_sec += ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+    return deadline;
+}
+
+static bool deadline_passed(const struct timespec* deadline) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+// Main thread, with park_mutex held: asks every worker to stop where its frames and deque are consistent
+// (see scheduler_quiesce) and waits until they all have. Returns false if the search finished first.
+// Workers are asked through their donate requests, which they poll anyway, so the search itself pays nothing for this.
+static bool scheduler_stop(Scheduler_t* scheduler) {
+    atomic_store(&scheduler->checkpoint_requested, true);
+    ASSERT_ZERO(pthread_cond_broadcast(&scheduler->park_cond));
+    while (scheduler->quiesced < scheduler->workers && !atomic_load(&scheduler->finish)) {
+        // Repeated, since a worker may clear its request for a thief that asked at the same time.
+        scheduler_request_stop(scheduler);
+        struct timespec retry = deadline_after(QUIESCE_RETRY_NS);
+        pthread_cond_timedwait(&scheduler->main_cond, &scheduler->park_mutex, &retry);
+    }
+    return !atomic_load(&scheduler->finish);
+}
+
+// Main thread, with park_mutex held: lets the workers stopped by scheduler_stop go on, or makes them quit,
+// leaving their frames and deques as they are, if `finish`.
+static void scheduler_restart(Scheduler_t* scheduler, bool finish) {
+    if (finish) {
+        atomic_store(&scheduler->finish, true);
+    }
+    atomic_store(&scheduler->checkpoint_requested, false);
+    scheduler->quiesced = 0;
+    ASSERT_ZERO(pthread_cond_broadcast(&scheduler->park_cond));
+}
+
+// SEARCH FUNCTIONS
+
+// The start nodes are roots of all the others, so a Search_t must not move.
+struct Search {
+    Scheduler_t* scheduler;
+    SPSPool_t* sps_pool;
+    SPS_t a;
+    SPS_t b;
+    atomic_int best_sum; // shared incumbent of the workers
+    Solution* solutions;
+    TR_t* resources;
+    int workers;
+    uint64_t start_ns;
+
+    Sweep* sweeps; // of each worker, if options->sweep
+    atomic_int sweep_best[MAX_D + 1];
+
+    int running; // workers that haven't returned yet, guarded by join_mutex
+    pthread_mutex_t join_mutex;
+    pthread_cond_t join_cond; // signaled when the last worker returns
+};
+
+// A worker, as a task of the pool.
+static void search_work(void* args) {
+    TR_t* resources = (TR_t*) args;
+    Search_t* search = resources->search;
+    thread_calculations(resources);
+
+    ASSERT_ZERO(pthread_mutex_lock(&search->join_mutex));
+    if (--search->running == 0) {
+        ASSERT_ZERO(pthread_cond_broadcast(&search->join_cond));
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&search->join_mutex));
+}
+
+Search_t* search_start(WorkerPool* pool, InputData* input_data, const Options* options, Cache* cache,
+    const Checkpoint* branches, int best_sum, int events_fd) {
+    Search_t* search = (Search_t*) aligned_alloc(CACHE_LINE_SIZE, sizeof(Search_t));
+    check_mem_alloc(search);
+    int workers = input_data->t;
+    search->workers = workers;
+
+    // create per-thread deques and sps pool and put first branch on the first deque
+    Scheduler_t* scheduler = scheduler_init(workers);
+    scheduler->events_fd = events_fd;
+    search->scheduler = scheduler;
+    search->sps_pool = sps_pool_init(workers);
+
+    SPS_t* a = &search->a;
+    sumset_copy(&a->sumset, &input_data->a_start);
+    a->parent = NULL;
+    a->frame_depth = -1;
+    atomic_store(&a->parent_to, 7);
+
+    SPS_t* b = &search->b;
+    sumset_copy(&b->sumset, &input_data->b_start);
+    b->parent = NULL;
+    b->frame_depth = -1;
+    atomic_store(&b->parent_to, 7);
+
+    atomic_init(&search->best_sum, best_sum);
+
+    // create starter packs for threads
+    search->solutions = (Solution*) malloc(workers * sizeof(Solution));
+    check_mem_alloc(search->solutions);
+    search->resources = (TR_t*) malloc(workers * sizeof(TR_t));
+    check_mem_alloc(search->resources);
+    search->sweeps = NULL;
+    if (options->sweep) {
+        search->sweeps = (Sweep*) malloc(workers * sizeof(Sweep));
+        check_mem_alloc(search->sweeps);
+    }
+    for (int d = 0; d <= MAX_D; ++d) {
+        atomic_init(&search->sweep_best[d], 0);
+    }
+
+    for (int i = 0; i < workers; ++i) {
+        TR_t* starterPack = &search->resources[i];
+        solution_init(&search->solutions[i]);
+        starterPack->search = search;
+        starterPack->scheduler = scheduler;
+        starterPack->id = i;
+        starterPack->input = input_data;
+        starterPack->options = options;
+        starterPack->best_sum = &search->best_sum;
+        starterPack->cache = cache;
+        stats_init(&starterPack->stats);
+        starterPack->mySolution = &search->solutions[i];
+        starterPack->sps_slab = &search->sps_pool->slabs[i];
+        starterPack->cursors = (Cursor_t*) malloc(options->cursors * sizeof(Cursor_t));
+        check_mem_alloc(starterPack->cursors);
+        for (int c = 0; c < options->cursors; ++c) {
+            starterPack->cursors[c].depth = -1;
+        }
+        atomic_init(&starterPack->nodes_published, 0);
+        starterPack->sweep = NULL;
+        if (options->sweep) {
+            starterPack->sweep = &search->sweeps[i];
+            sweep_init(starterPack->sweep, input_data);
+        }
+        starterPack->sweep_best = search->sweep_best;
+    }
+
+    if (branches != NULL) {
+        search->solutions[0] = branches->best;
+        // Pushed in reverse, so that worker 0 pops them in the saved order.
+        for (int i = branches->branches_count - 1; i >= 0; --i) {
+            resume_branch(&search->resources[0], &branches->branches[i], a, b);
+        }
+        if (atomic_load(&scheduler->pending) == 0) {
+            atomic_store(&scheduler->finish, true);
+        }
+    } else switch (input_data_start_kind(input_data)) {
+    case SUMSET_NODE_OPEN:
+        if (!sumset_node_is_symmetric(&a->sumset, &b->sumset)) {
+            give_away_branch(scheduler, 0, a, b);
+            break;
+        }
+        root_split_symmetric(&search->resources[0], a, b);
+        if (atomic_load(&scheduler->pending) == 0) {
+            atomic_store(&scheduler->finish, true);
+        }
+        break;
+    case SUMSET_NODE_TERMINAL:
+        record_solution(&search->resources[0], &a->sumset, &b->sumset);
+        atomic_store(&scheduler->finish, true);
+        break;
+    case SUMSET_NODE_DEAD:
+        atomic_store(&scheduler->finish, true);
+        break;
+    }
+
+    // start threads work
+    search->running = workers;
+    ASSERT_ZERO(pthread_mutex_init(&search->join_mutex, NULL));
+    ASSERT_ZERO(pthread_cond_init(&search->join_cond, NULL));
+    search->start_ns = stats_now_ns();
+    for (int i = 0; i < workers; ++i) {
+        worker_pool_submit(pool, search_work, &search->resources[i]);
+    }
+    return search;
+}
+
+bool search_finished(Search_t* search) {
+    return atomic_load(&search->scheduler->finish);
+}
+
+bool search_poll(Search_t* search) {
+    ASSERT_ZERO(pthread_mutex_lock(&search->join_mutex));
+    bool done = search->running == 0;
+    ASSERT_ZERO(pthread_mutex_unlock(&search->join_mutex));
+    return done;
+}
+
+void search_join(Search_t* search) {
+    ASSERT_ZERO(pthread_mutex_lock(&search->join_mutex));
+    while (search->running > 0) {
+        ASSERT_ZERO(pthread_cond_wait(&search->join_cond, &search->join_mutex));
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&search->join_mutex));
+}
+
+const Solution* search_best(const Search_t* search) {
+    const Solution* best_solution = &search->solutions[0];
+    for (int i = 1; i < search->workers; ++i) {
+        if (search->solutions[i].sum > best_solution->sum) {
+            best_solution = &search->solutions[i];
+        }
+    }
+    return best_solution;
+}
+
+const Sweep* search_sweep(Search_t* search) {
+    for (int i = 1; i < search->workers; ++i) {
+        sweep_merge(&search->sweeps[0], &search->sweeps[i]);
+    }
+    return &search->sweeps[0];
+}
+
+int search_best_sum(Search_t* search) {
+    return atomic_load(&search->best_sum);
+}
+
+void search_raise_best_sum(Search_t* search, int sum) {
+    int known = atomic_load(&search->best_sum);
+    while (sum > known && !atomic_compare_exchange_weak(&search->best_sum, &known, sum)) {
+    }
+}
+
+int search_workers(const Search_t* search) {
+    return search->workers;
+}
+
+Stats* search_stats(Search_t* search, int worker) {
+    return &search->resources[worker].stats;
+}
+
+bool search_timer_loop(Search_t* search, const Checkpoint* resumed, double estimated_nodes, uint64_t deadline_ns,
+    Checkpoint* left) {
+    TR_t* resources = search->resources;
+    int workers = search->workers;
+    Scheduler_t* scheduler = search->scheduler;
+    const Options* options = resources->options;
+    uint64_t checkpoint_ns = options->checkpoint_interval * 1000000000ULL;
+    uint64_t progress_ns = options->progress_interval * 1000000000ULL;
+    uint64_t now = stats_now_ns();
+    uint64_t checkpoint_due = options->checkpoint_path ? now + checkpoint_ns : UINT64_MAX;
+    uint64_t progress_due = options->progress_interval ? now + progress_ns : UINT64_MAX;
+
+    bool stopped = false;
+    ASSERT_ZERO(pthread_mutex_lock(&scheduler->park_mutex));
+    while (!atomic_load(&scheduler->finish)) {
+        if (!target_reached(resources)) {
+            uint64_t due = checkpoint_due < progress_due ? checkpoint_due : progress_due;
+            if (deadline_ns < due) {
+                due = deadline_ns;
+            }
+            struct timespec deadline = deadline_after(due > now ? due - now : 0);
+            pthread_cond_timedwait(&scheduler->main_cond, &scheduler->park_mutex, &deadline);
+        }
+        // Timeouts are told apart from other wakeups by the clock.
+        now = stats_now_ns();
+        if (target_reached(resources)) {
+            deadline_ns = now;
+        }
+
+        if (now >= progress_due) {
+            unsigned long nodes = resumed->stats.nodes_expanded;
+            for (int i = 0; i < workers; ++i) {
+                nodes += atomic_load_explicit(&resources[i].nodes_published, memory_order_relaxed);
+            }
+            estimate_print_progress(estimated_nodes, nodes, resumed->stats.nodes_expanded, now - search->start_ns);
+            progress_due = now + progress_ns;
+        }
+
+        if (now >= deadline_ns) {
+            stopped = scheduler_stop(scheduler);
+            if (stopped) {
+                checkpoint_collect(left, resources, workers, resumed, search->start_ns, false);
+            }
+            scheduler_restart(scheduler, true);
+            break;
+        }
+
+        if (now >= checkpoint_due) {
+            if (scheduler_stop(scheduler)) {
+                checkpoint_save(resources, workers, resumed, search->start_ns, false);
+            }
+            scheduler_restart(scheduler, false);
+            now = stats_now_ns();
+            checkpoint_due = now + checkpoint_ns;
+        }
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&scheduler->park_mutex));
+    return stopped;
+}
+
+bool search_split(Search_t* search, Checkpoint* frontier) {
+    Scheduler_t* scheduler = search->scheduler;
+    ASSERT_ZERO(pthread_mutex_lock(&scheduler->park_mutex));
+    bool stopped = scheduler_stop(scheduler);
+    if (stopped) {
+        for (int i = 0; i < search->workers; ++i) {
+            checkpoint_add_worker(frontier, &search->resources[i]);
+        }
+    }
+    scheduler_restart(scheduler, stopped);
+    ASSERT_ZERO(pthread_mutex_unlock(&scheduler->park_mutex));
+    return stopped;
+}
+
+void search_checkpoint_save(Search_t* search, const Checkpoint* resumed) {
+    checkpoint_save(search->resources, search->workers, resumed, search->start_ns, true);
+}
+
+void search_destroy(Search_t* search) {
+    scheduler_destroy(search->scheduler);
+    sps_pool_destroy(search->sps_pool);
+    ASSERT_ZERO(pthread_mutex_destroy(&search->join_mutex));
+    ASSERT_ZERO(pthread_cond_destroy(&search->join_cond));
+    free(search->solutions);
+    for (int i = 0; i < search->workers; ++i) {
+        free(search->resources[i].cursors);
+    }
+    free(search->resources);
+    free(search->sweeps);
+    free(search);
+}
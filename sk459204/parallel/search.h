@@ -0,0 +1,82 @@
+#pragma once
+#include "common/cache.h"
+#include "common/checkpoint.h"
+#include "common/io.h"
+#include "common/options.h"
+#include "common/stats.h"
+#include "common/sweep.h"
+#include "common/width.h"
+#include "common/worker_pool.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Width-specific functions (see width.h).
+#define search_start WIDTH_NAME(search_start)
+#define search_finished WIDTH_NAME(search_finished)
+#define search_poll WIDTH_NAME(search_poll)
+#define search_join WIDTH_NAME(search_join)
+#define search_best WIDTH_NAME(search_best)
+#define search_sweep WIDTH_NAME(search_sweep)
+#define search_best_sum WIDTH_NAME(search_best_sum)
+#define search_raise_best_sum WIDTH_NAME(search_raise_best_sum)
+#define search_workers WIDTH_NAME(search_workers)
+#define search_stats WIDTH_NAME(search_stats)
+#define search_timer_loop WIDTH_NAME(search_timer_loop)
+#define search_split WIDTH_NAME(search_split)
+#define search_checkpoint_save WIDTH_NAME(search_checkpoint_save)
+#define search_destroy WIDTH_NAME(search_destroy)
+
+// The parallel search engine: one run of work-stealing workers, from the start node or from a list of branches
+// (resumed from a checkpoint, of a shard, or handed out by a coordinator). The workers run as tasks of a worker
+// pool, and keep no state outside their Search_t, so any number of searches can run in one process.
+typedef struct Search Search_t;
+
+// Starts input_data->t workers on `pool`, on the start node or on the branches of `branches` (with its best solution)
+// if it's not NULL, pruning with `best_sum` as the best sum found so far. `input_data`, `options` and `cache` (NULL
+// for none) must outlive the search. `events_fd` is the write end of a pipe written when the search finishes or
+// a better solution is found, -1 for none.
+Search_t* search_start(WorkerPool* pool, InputData* input_data, const Options* options, Cache* cache,
+    const Checkpoint* branches, int best_sum, int events_fd);
+
+// Whether the search is over. Its workers may still be returning, see search_join.
+bool search_finished(Search_t* search);
+
+// Whether all workers have returned, so that search_join won't block.
+bool search_poll(Search_t* search);
+
+// Waits for the workers, once the search is over or stopped.
+void search_join(Search_t* search);
+
+// Best solution found by any worker, once they have returned.
+const Solution* search_best(const Search_t* search);
+
+// Best solutions of all workers for every d', once they have returned, if options->sweep. Call it once.
+const Sweep* search_sweep(Search_t* search);
+
+// The incumbent shared by the workers, and a way to raise it with a sum found elsewhere.
+int search_best_sum(Search_t* search);
+void search_raise_best_sum(Search_t* search, int sum);
+
+int search_workers(const Search_t* search);
+
+// Counters of one of the workers, complete once they have returned.
+Stats* search_stats(Search_t* search, int worker);
+
+// Main thread: until the search is over, writes a checkpoint every checkpoint_interval seconds if there's
+// a checkpoint path, and reports progress against `estimated_nodes` every progress_interval seconds if asked to.
+// At `deadline_ns` (UINT64_MAX for none), or once the target is reached, stops the workers where they are,
+// collects what's left of the search into the empty `left` and returns true. `resumed` has the counters
+// of earlier runs. Stopping the workers needs all of them running, so the pool must have a thread for each.
+bool search_timer_loop(Search_t* search, const Checkpoint* resumed, double estimated_nodes, uint64_t deadline_ns,
+    Checkpoint* left);
+
+// Stops the workers and adds their frontiers to `frontier`, then makes them quit. Returns false if the search was
+// over first. Like search_timer_loop, needs a pool thread for each worker.
+bool search_split(Search_t* search, Checkpoint* frontier);
+
+// Writes a checkpoint with the best solution and the counters of the workers added to the ones of `resumed`, and
+// no branches (the search is over, once the workers have returned).
+void search_checkpoint_save(Search_t* search, const Checkpoint* resumed);
+
+void search_destroy(Search_t* search);
@@ -1,40 +1,130 @@
 #include <stddef.h>
 
+#include "common/cache.h"
 #include "common/io.h"
+#include "common/options.h"
+#include "common/stats.h"
 #include "common/sumset.h"
+#include "common/sweep.h"
 
+#include <stdbool.h>
 #include <stdio.h>
 
 static InputData input_data;
 
+static Options options;
+
 static Solution best_solution;
 
-static void solve(const Sumset* a, const Sumset* b)
+static Stats stats;
+
+static Cache* cache;
+
+static Sweep sweep; // best solutions for every d', if options.sweep
+
+// Whether the node (a, b) can't beat the best solution found so far.
+static bool is_pruned(const Sumset* a, const Sumset* b)
+{
+    if (!options.bound)
+        return false;
+    if (options.sweep ? !sweep_is_pruned(&sweep, options.bound, a, b)
+                      : options.bound(a, b, input_data.d) > best_solution.sum)
+        return false;
+    stats.pruned++;
+    return true;
+}
+
+// Whether the node (a, b), or one dominating it, was already visited through another path.
+static bool is_cached(const Sumset* a, const Sumset* b)
+{
+    if (!cache || !cache_covers(cache, b))
+        return false;
+    if (cache_visit(cache, a, b)) {
+        stats.cache_hits++;
+        return true;
+    }
+    stats.cache_misses++;
+    return false;
+}
+
+static void record_solution(const Sumset* a, const Sumset* b)
+{
+    stats.terminal_checks++;
+    if (options.sweep)
+        sweep_record(&sweep, &input_data, a, b);
+    else if (b->sum > best_solution.sum)
+        solution_build(&best_solution, &input_data, a, b);
+}
+
+// Expand the open node (a, b) (with s(a) ∩ s(b) = {0}).
+// If `symmetric` (see sumset_node_is_symmetric), each open child is expanded against b with last raised to i.
+static void solve(const Sumset* a, const Sumset* b, bool symmetric)
 {
     if (a->sum > b->sum)
-        return solve(b, a);
-
-    if (is_sumset_intersection_trivial(a, b)) { // s(a) ∩ s(b) = {0}.
-        for (size_t i = a->last; i <= input_data.d; ++i) {
-            if (!does_sumset_contain(b, i)) {
-                Sumset a_with_i;
-                sumset_add(&a_with_i, a, i);
-                solve(&a_with_i, b);
-            }
+        return solve(b, a, symmetric);
+
+    if (is_pruned(a, b) || is_cached(a, b))
+        return;
+
+    SumsetChildren children;
+    sumset_expand(a, b, input_data.d, &children);
+    stats.nodes_expanded++;
+    stats.children_generated += element_set_size(&children.all);
+    stats.children_rejected += children.rejected;
+    while (!element_set_is_empty(&children.all)) {
+        int i = element_set_pop_min(&children.all);
+        Sumset a_with_i;
+        sumset_add(&a_with_i, a, i);
+        if (!element_set_contains(&children.open, i)) { // s(a_with_i) ∩ s(b) = {0, ∑b}.
+            record_solution(&a_with_i, b);
+        } else if (symmetric) {
+            Sumset b_from_i;
+            sumset_copy(&b_from_i, b);
+            b_from_i.last = i;
+            solve(&a_with_i, &b_from_i, false);
+        } else {
+            solve(&a_with_i, b, false);
         }
-    } else if ((a->sum == b->sum) && (get_sumset_intersection_size(a, b) == 2)) { // s(a) ∩ s(b) = {0, ∑b}.
-        if (b->sum > best_solution.sum)
-            solution_build(&best_solution, &input_data, a, b);
     }
 }
 
-int main()
+int solver_main(int argc, char* argv[], const TaskInput* task)
 {
-    input_data_read(&input_data);
+    options_parse(&options, argc, argv);
+    options_check_implementation(&options, IMPLEMENTATION_REFERENCE, argv[0]);
+    input_data_load(&input_data, task);
     //input_data_init(&input_data, 8, 34, (int[]){0}, (int[]){1, 0});
 
     solution_init(&best_solution);
-    solve(&input_data.a_start, &input_data.b_start);
-    solution_print(&best_solution);
+    if (options.sweep)
+        sweep_init(&sweep, &input_data);
+    stats_init(&stats);
+    if (options.cache_bytes)
+        cache = cache_create(options.cache_bytes, input_data.d, options.cache_max_sum);
+    uint64_t start = stats_now_ns();
+    switch (input_data_start_kind(&input_data)) {
+    case SUMSET_NODE_OPEN:
+        solve(&input_data.a_start, &input_data.b_start,
+            sumset_node_is_symmetric(&input_data.a_start, &input_data.b_start));
+        break;
+    case SUMSET_NODE_TERMINAL:
+        record_solution(&input_data.a_start, &input_data.b_start);
+        break;
+    case SUMSET_NODE_DEAD:
+        break;
+    }
+    stats.run_ns = stats_now_ns() - start;
+    if (options.sweep)
+        sweep_print(&sweep);
+    else
+        solution_print(&best_solution);
+    if (options.bound)
+        fprintf(stderr, "branch-and-bound: pruned=%lu\n", stats.pruned);
+    if (cache) {
+        fprintf(stderr, "cache: hits=%lu misses=%lu\n", stats.cache_hits, stats.cache_misses);
+        cache_destroy(cache);
+    }
+    if (options.stats)
+        stats_print(&stats, 1);
     return 0;
 }
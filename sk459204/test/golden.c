@@ -0,0 +1,258 @@
+// Runs a solver on one instance and checks its output against the known answer (see CMakeLists.txt here).
+//
+// Usage: golden [--expect=SUM] [--budget-ms=MS] SOLVER T D A0 B0 [SOLVER_OPTION...]
+//
+// A0 and B0 are comma-separated elements in [1, 128] (also above D, to check that α is 0 then), or "-" for an empty
+// multiset. The solver gets the task input "T D n m / A0 / B0" on stdin. The test fails (with a message on stderr
+// and exit status 1) if the solver fails, or:
+// - with --expect, if it prints anything but a valid solution: ∑A = ∑B = SUM, A ⊇ A0 and B ⊇ B0, all elements in
+//   [1, D], and A^Σ ∩ B^Σ = {0, SUM} (undisputed), or "0" and two empty multisets if SUM is 0;
+// - with --budget-ms, if it runs longer than MS milliseconds (it's killed then).
+// At least one of them must be given.
+#include "common/err.h"
+#include "common/stats.h"
+
+#include <getopt.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define GOLDEN_MAX_D 128
+#define GOLDEN_POLL_NS 1000000
+
+enum {
+    OPTION_EXPECT = 256,
+    OPTION_BUDGET_MS,
+};
+
+typedef struct Multiset {
+    int count[GOLDEN_MAX_D + 1];
+} Multiset;
+
+static _Noreturn void usage(const char* program)
+{
+    fatal("usage: %s [--expect=SUM] [--budget-ms=MS] SOLVER T D A0 B0 [SOLVER_OPTION...]", program);
+}
+
+static long parse_number(const char* program, const char* arg, long min, long max)
+{
+    char* end;
+    long number = strtol(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0' || number < min || number > max)
+        usage(program);
+    return number;
+}
+
+// Parse "x,y,..." or "-" into `m`, and append the elements to `text` as a line.
+static int parse_elements(const char* program, const char* arg, Multiset* m, char* text, size_t size)
+{
+    memset(m, 0, sizeof(Multiset));
+    int n = 0;
+    if (strcmp(arg, "-") != 0) {
+        char copy[strlen(arg) + 1];
+        strcpy(copy, arg);
+        for (char* token = strtok(copy, ","); token != NULL; token = strtok(NULL, ",")) {
+            int x = parse_number(program, token, 1, GOLDEN_MAX_D);
+            m->count[x]++;
+            n++;
+            snprintf(text + strlen(text), size - strlen(text), "%s%d", n > 1 ? " " : "", x);
+        }
+    }
+    snprintf(text + strlen(text), size - strlen(text), "\n");
+    return n;
+}
+
+// A temporary file holding `text`, rewound.
+static FILE* text_file(const char* text)
+{
+    FILE* file = tmpfile();
+    if (file == NULL)
+        syserr("cannot create a temporary file");
+    fputs(text, file);
+    rewind(file);
+    return file;
+}
+
+// Run the solver with `in` as stdin and `out` as stdout, killing it after budget_ms (unless it's -1). Returns the
+// wall time.
+static double run_solver(char* argv[], FILE* in, FILE* out, long budget_ms)
+{
+    uint64_t start_ns = stats_now_ns();
+    pid_t pid = fork();
+    ASSERT_SYS_OK(pid);
+    if (pid == 0) {
+        ASSERT_SYS_OK(dup2(fileno(in), STDIN_FILENO));
+        ASSERT_SYS_OK(dup2(fileno(out), STDOUT_FILENO));
+        execv(argv[0], argv);
+        syserr("cannot run %s", argv[0]);
+    }
+
+    int status;
+    pid_t done;
+    while ((done = waitpid(pid, &status, WNOHANG)) == 0) {
+        if (budget_ms >= 0 && stats_now_ns() - start_ns > (uint64_t)budget_ms * 1000000) {
+            ASSERT_SYS_OK(kill(pid, SIGKILL));
+            ASSERT_SYS_OK(waitpid(pid, &status, 0));
+            fatal("%s is over its time budget of %ld ms", argv[0], budget_ms);
+        }
+        nanosleep(&(struct timespec) { .tv_sec = 0, .tv_nsec = GOLDEN_POLL_NS }, NULL);
+    }
+    ASSERT_SYS_OK(done);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        fatal("%s failed (status %d)", argv[0], status);
+    return (stats_now_ns() - start_ns) / 1e9;
+}
+
+// Parse a multiset description ("2x3 4", see solution_print) from a line of the output.
+static void read_multiset(FILE* out, const char* name, int d, Multiset* m)
+{
+    char* line = NULL;
+    size_t size = 0;
+    if (getline(&line, &size, out) < 0)
+        fatal("output: no line for %s", name);
+    memset(m, 0, sizeof(Multiset));
+    for (char* token = strtok(line, " \n"); token != NULL; token = strtok(NULL, " \n")) {
+        int count, x;
+        char end;
+        if (sscanf(token, "%dx%d%c", &count, &x, &end) != 2) {
+            count = 1;
+            if (sscanf(token, "%d%c", &x, &end) != 1)
+                fatal("output: malformed element \"%s\" in %s", token, name);
+        }
+        if (x < 1 || x > d || count < 1)
+            fatal("output: %s has %dx%d, not in [1, %d]", name, count, x, d);
+        m->count[x] += count;
+    }
+    free(line);
+}
+
+// Subset sums of m, as a table of sum + 1 flags.
+static bool* subset_sums(const Multiset* m, int sum)
+{
+    bool* sums = calloc(sum + 1, sizeof(bool));
+    if (sums == NULL)
+        fatal("cannot allocate %d sums", sum + 1);
+    sums[0] = true;
+    int reached = 0;
+    for (int x = 1; x <= GOLDEN_MAX_D; x++) {
+        for (int k = 0; k < m->count[x]; k++) {
+            for (int s = reached; s >= 0; s--) {
+                if (sums[s])
+                    sums[s + x] = true;
+            }
+            reached += x;
+        }
+    }
+    return sums;
+}
+
+static int multiset_sum(const Multiset* m)
+{
+    int sum = 0;
+    for (int x = 1; x <= GOLDEN_MAX_D; x++)
+        sum += x * m->count[x];
+    return sum;
+}
+
+static void check_contains(const Multiset* m, const Multiset* forced, const char* name)
+{
+    for (int x = 1; x <= GOLDEN_MAX_D; x++) {
+        if (m->count[x] < forced->count[x])
+            fatal("output: %s has %d of %d, fewer than forced", name, m->count[x], x);
+    }
+}
+
+// Check that `out` holds a valid solution with sum `expect` (see the top of this file).
+static void check_output(FILE* out, long expect, int d, const Multiset* a0, const Multiset* b0)
+{
+    rewind(out);
+    int sum;
+    if (fscanf(out, "%d", &sum) != 1 || fgetc(out) != '\n')
+        fatal("output: no sum");
+    if (sum != expect)
+        fatal("output: sum %d, expected %ld", sum, expect);
+    Multiset a, b;
+    read_multiset(out, "A", d, &a);
+    read_multiset(out, "B", d, &b);
+
+    if (sum == 0) {
+        if (multiset_sum(&a) != 0 || multiset_sum(&b) != 0)
+            fatal("output: sum 0 with non-empty multisets");
+    } else {
+        if (multiset_sum(&a) != sum || multiset_sum(&b) != sum)
+            fatal("output: ∑A=%d and ∑B=%d, not the printed sum %d", multiset_sum(&a), multiset_sum(&b), sum);
+        check_contains(&a, a0, "A");
+        check_contains(&b, b0, "B");
+        bool* a_sums = subset_sums(&a, sum);
+        bool* b_sums = subset_sums(&b, sum);
+        for (int s = 1; s < sum; s++) {
+            if (a_sums[s] && b_sums[s])
+                fatal("output: %d is a subset sum of both A and B, the pair is disputed", s);
+        }
+        free(a_sums);
+        free(b_sums);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    static const struct option long_options[] = {
+        { "expect", required_argument, NULL, OPTION_EXPECT },
+        { "budget-ms", required_argument, NULL, OPTION_BUDGET_MS },
+        { NULL, 0, NULL, 0 },
+    };
+    long expect = -1, budget_ms = -1;
+    int c;
+    // "+": stop at SOLVER, the options after it are the solver's.
+    while ((c = getopt_long(argc, argv, "+", long_options, NULL)) != -1) {
+        switch (c) {
+        case OPTION_EXPECT:
+            expect = parse_number(argv[0], optarg, 0, GOLDEN_MAX_D * GOLDEN_MAX_D);
+            break;
+        case OPTION_BUDGET_MS:
+            budget_ms = parse_number(argv[0], optarg, 1, 1L << 30);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if ((expect < 0 && budget_ms < 0) || argc - optind < 5)
+        usage(argv[0]);
+    char** solver_argv = &argv[optind];
+    int t = parse_number(argv[0], argv[optind + 1], 1, 1 << 20);
+    int d = parse_number(argv[0], argv[optind + 2], 3, GOLDEN_MAX_D);
+
+    char a_text[4 * GOLDEN_MAX_D * GOLDEN_MAX_D] = "", b_text[4 * GOLDEN_MAX_D * GOLDEN_MAX_D] = "";
+    Multiset a0, b0;
+    int n = parse_elements(argv[0], argv[optind + 3], &a0, a_text, sizeof(a_text));
+    int m = parse_elements(argv[0], argv[optind + 4], &b0, b_text, sizeof(b_text));
+    char input[sizeof(a_text) + sizeof(b_text) + 64];
+    snprintf(input, sizeof(input), "%d %d %d %d\n%s%s", t, d, n, m, a_text, b_text);
+
+    // The solver's argv: SOLVER and its options, without the instance.
+    char* args[argc - optind - 3];
+    args[0] = solver_argv[0];
+    for (int i = 5; i < argc - optind; i++)
+        args[i - 4] = solver_argv[i];
+    args[argc - optind - 4] = NULL;
+
+    FILE* in = text_file(input);
+    FILE* out = text_file("");
+    double wall_s = run_solver(args, in, out, budget_ms);
+    if (expect >= 0)
+        check_output(out, expect, d, &a0, &b0);
+    fclose(in);
+    fclose(out);
+    printf("golden: wall_s=%.3f", wall_s);
+    if (expect >= 0)
+        printf(" sum=%ld", expect);
+    if (budget_ms >= 0)
+        printf(" budget_s=%.3f", budget_ms / 1e3);
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Checks that every kernel variant the CPU supports gives bit-identical results to the scalar one (see
+// SumsetKernels in common/sumset.h).
+//
+// Usage: kernels_check [ROUNDS]
+//
+// Each of ROUNDS rounds (256 by default) runs every kernel on random words for every shift x in [1, MAX_D], with
+// the same inputs on every run: short and long sumsets, in-place adds, and trivial and non-trivial intersections
+// (also of a shifted sumset with b, for the fused kernel). Prints one line per variant, and fails (with a message
+// on stderr and exit status 1) at the first difference. Variants the CPU doesn't support are reported as skipped.
+#include "common/err.h"
+#include "common/sumset.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A small xorshift generator, so that the check is the same on every run.
+static uint64_t next_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Fill the live words of a random sumset with the given sum (bits above sum cleared, bit 0 set).
+static void random_words(uint64_t* state, Word* words, int sum, int density_shift)
+{
+    int live = sumset_live_words(sum);
+    for (int i = 0; i < live; ++i) {
+        words[i] = next_random(state);
+        for (int j = 0; j < density_shift; ++j)
+            words[i] &= next_random(state);
+    }
+    if ((sum + 1) % BITS_PER_WORD != 0)
+        words[live - 1] &= (((Word)1) << ((sum + 1) % BITS_PER_WORD)) - 1;
+    words[0] |= 1;
+}
+
+static void check_round(const char* name, int round, uint64_t* state)
+{
+    Word a[MAX_WORDS + 1], b[MAX_WORDS + 1];
+    Word expected[MAX_WORDS + 1], actual[MAX_WORDS + 1];
+    for (int x = 1; x <= MAX_D; ++x) {
+        int a_sum = next_random(state) % (MAX_BITS - x);
+        int a_words = sumset_live_words(a_sum);
+        int words = sumset_live_words(a_sum + x);
+        random_words(state, a, a_sum, round % 3);
+
+        // Sentinels past the live words must not be written.
+        expected[words] = actual[words] = 0xdeadbeef;
+        _sumset_add_scalar(expected, a, a_words, words, x);
+        sumset_kernels.add(actual, a, a_words, words, x);
+        if (memcmp(expected, actual, (words + 1) * sizeof(Word)) != 0)
+            fatal("%s: add differs (round %d, sum %d, x %d)", name, round, a_sum, x);
+        memcpy(actual, a, a_words * sizeof(Word));
+        sumset_kernels.add(actual, actual, a_words, words, x);
+        if (memcmp(expected, actual, words * sizeof(Word)) != 0)
+            fatal("%s: in-place add differs (round %d, sum %d, x %d)", name, round, a_sum, x);
+
+        int b_sum = next_random(state) % MAX_BITS;
+        random_words(state, b, b_sum, 2 + round % 4);
+        if (round % 2 == 0) {
+            // Make the intersection trivial, or break it with a single bit.
+            for (int i = 0; i < sumset_live_words(b_sum); ++i)
+                b[i] &= (i < a_words) ? ~a[i] : ~(Word)0;
+            b[0] |= 1;
+            if (round % 4 == 0) {
+                int bit = next_random(state) % (a_sum + 1);
+                if (bit <= b_sum && (a[bit / BITS_PER_WORD] & (((Word)1) << (bit % BITS_PER_WORD))))
+                    b[bit / BITS_PER_WORD] |= ((Word)1) << (bit % BITS_PER_WORD);
+            }
+        }
+        int b_words = sumset_live_words(b_sum);
+        size_t expected_size = _sumset_add_and_intersect_scalar(expected, a, a_words, words, x, b, b_words);
+        if (sumset_kernels.add_and_intersect(actual, a, a_words, words, x, b, b_words) != expected_size
+            || memcmp(expected, actual, words * sizeof(Word)) != 0)
+            fatal("%s: add_and_intersect differs (round %d, sums %d and %d, x %d)", name, round, a_sum, b_sum, x);
+
+        int common = sumset_live_words(a_sum < b_sum ? a_sum : b_sum);
+        if (_sumset_intersection_size_scalar(a, b, common) != sumset_kernels.intersection_size(a, b, common))
+            fatal("%s: intersection_size differs (round %d, sums %d and %d)", name, round, a_sum, b_sum);
+        if (_sumset_is_intersection_trivial_scalar(a, b, common)
+            != sumset_kernels.is_intersection_trivial(a, b, common))
+            fatal("%s: is_intersection_trivial differs (round %d, sums %d and %d)", name, round, a_sum, b_sum);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 256;
+    if (argc > 2 || rounds < 1)
+        fatal("usage: %s [ROUNDS]", argv[0]);
+    static const char* const variants[] = { "scalar", "avx2", "avx512" };
+    for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        if (!sumset_kernels_select(variants[i])) {
+            printf("kernels: variant=%s skipped (not supported by the CPU)\n", variants[i]);
+            continue;
+        }
+        uint64_t state = 0x9e3779b97f4a7c15ULL;
+        for (int round = 0; round < rounds; ++round)
+            check_round(variants[i], round, &state);
+        printf("kernels: variant=%s rounds=%d agree\n", variants[i], rounds);
+    }
+    return 0;
+}
@@ -0,0 +1,234 @@
+// Solves a table of instances with libmultiset and checks the answers against a solver executable (see
+// CMakeLists.txt here).
+//
+// Usage: library_check SOLVER
+//
+// Every instance is first solved by SOLVER (given the task input on stdin, like in golden.c), then on one pool of
+// LIBRARY_THREADS threads: all submitted at once and polled until done, and again one after another with
+// multiset_solve. Fails (with a message on stderr and exit status 1) if a sum differs from SOLVER's, or a witness
+// isn't an undisputed pair with ∑A = ∑B = α, A ⊇ A₀ and B ⊇ B₀ in [1, d]. Invalid instances and options must be
+// rejected without being run.
+#include "common/err.h"
+#include "library/multiset.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LIBRARY_THREADS 4
+#define LIBRARY_POLL_NS 1000000
+#define LIBRARY_MAX_ELEMENTS 32
+
+typedef struct Instance {
+    const char* name;
+    int d;
+    int n, m;
+    int a[LIBRARY_MAX_ELEMENTS], b[LIBRARY_MAX_ELEMENTS];
+    const char* bound;
+} Instance;
+
+// A tenth of a second or less each for the reference solver at -O3.
+static const Instance instances[] = {
+    { "empty_d14", 14, 0, 0, { 0 }, { 0 }, NULL },
+    { "one_d16", 16, 0, 1, { 0 }, { 1 }, NULL },
+    { "empty_d18_bnb", 18, 0, 0, { 0 }, { 0 }, "pigeonhole" },
+    { "forced_d22", 22, 1, 1, { 2 }, { 3 }, NULL },
+    { "forced_d40", 40, 2, 1, { 1, 2 }, { 4 }, NULL },
+    { "forced_d50", 50, 2, 2, { 1, 3 }, { 2, 7 }, NULL },
+    { "terminal_d100", 100, 2, 1, { 2, 5 }, { 7 }, NULL },
+    { "dead_d20", 20, 3, 2, { 3, 3, 4 }, { 5, 7 }, NULL },
+    // ∑B₀ = 272 needs sumsets of width 32 for d = 16.
+    { "wide_b0_d16", 16, 1, 17, { 1 },
+        { 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16 }, NULL },
+};
+
+#define INSTANCES_COUNT ((int)(sizeof(instances) / sizeof(instances[0])))
+
+// α of the instance from the solver executable.
+static int solver_sum(const char* solver, const Instance* instance)
+{
+    FILE* in = tmpfile();
+    FILE* out = tmpfile();
+    if (in == NULL || out == NULL)
+        syserr("cannot create a temporary file");
+    fprintf(in, "1 %d %d %d\n", instance->d, instance->n, instance->m);
+    for (int i = 0; i < instance->n; i++)
+        fprintf(in, "%d ", instance->a[i]);
+    fprintf(in, "\n");
+    for (int i = 0; i < instance->m; i++)
+        fprintf(in, "%d ", instance->b[i]);
+    fprintf(in, "\n");
+    rewind(in);
+
+    pid_t pid = fork();
+    ASSERT_SYS_OK(pid);
+    if (pid == 0) {
+        ASSERT_SYS_OK(dup2(fileno(in), STDIN_FILENO));
+        ASSERT_SYS_OK(dup2(fileno(out), STDOUT_FILENO));
+        char* args[] = { (char*)solver, instance->bound != NULL ? "-b" : NULL, NULL };
+        execv(solver, args);
+        syserr("cannot run %s", solver);
+    }
+    int status;
+    ASSERT_SYS_OK(waitpid(pid, &status, 0));
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        fatal("%s failed on %s (status %d)", solver, instance->name, status);
+
+    rewind(out);
+    int sum;
+    if (fscanf(out, "%d", &sum) != 1)
+        fatal("%s printed no solution for %s", solver, instance->name);
+    fclose(in);
+    fclose(out);
+    return sum;
+}
+
+// Subset sums of the multiset `count`, as a table of sum + 1 flags.
+static bool* subset_sums(const int count[MULTISET_MAX_D + 1], int sum)
+{
+    bool* sums = calloc(sum + 1, sizeof(bool));
+    if (sums == NULL)
+        fatal("cannot allocate %d sums", sum + 1);
+    sums[0] = true;
+    int reached = 0;
+    for (int x = 1; x <= MULTISET_MAX_D; x++) {
+        for (int k = 0; k < count[x]; k++) {
+            for (int s = reached; s >= 0; s--) {
+                if (sums[s])
+                    sums[s + x] = true;
+            }
+            reached += x;
+        }
+    }
+    return sums;
+}
+
+// Check one side of the witness: ∑ = sum, elements in [1, d], and the forced ones included.
+static void check_side(const char* how, const Instance* instance, const char* name, const int count[],
+    const int* forced, int forced_count, int sum)
+{
+    int total = 0;
+    for (int x = 0; x <= MULTISET_MAX_D; x++) {
+        if (count[x] > 0 && (x < 1 || x > instance->d))
+            fatal("%s: %s: %s has %d, not in [1, %d]", how, instance->name, name, x, instance->d);
+        total += x * count[x];
+    }
+    if (total != sum)
+        fatal("%s: %s: ∑%s=%d, not the sum %d", how, instance->name, name, total, sum);
+    if (sum == 0)
+        return;
+    int forced_counts[MULTISET_MAX_D + 1] = { 0 };
+    for (int i = 0; i < forced_count; i++)
+        forced_counts[forced[i]]++;
+    for (int x = 1; x <= MULTISET_MAX_D; x++) {
+        if (count[x] < forced_counts[x])
+            fatal("%s: %s: %s has %d of %d, fewer than forced", how, instance->name, name, count[x], x);
+    }
+}
+
+static void check_solution(const char* how, const Instance* instance, const MultisetSolution* solution,
+    int expected)
+{
+    if (solution->sum != expected)
+        fatal("%s: %s: sum %d, the solver says %d", how, instance->name, solution->sum, expected);
+    check_side(how, instance, "A", solution->a, instance->a, instance->n, solution->sum);
+    check_side(how, instance, "B", solution->b, instance->b, instance->m, solution->sum);
+    if (solution->sum == 0)
+        return;
+    bool* a_sums = subset_sums(solution->a, solution->sum);
+    bool* b_sums = subset_sums(solution->b, solution->sum);
+    for (int s = 1; s < solution->sum; s++) {
+        if (a_sums[s] && b_sums[s])
+            fatal("%s: %s: %d is a subset sum of both A and B, the pair is disputed", how, instance->name, s);
+    }
+    free(a_sums);
+    free(b_sums);
+}
+
+static void options_for(const Instance* instance, int threads, MultisetOptions* options)
+{
+    multiset_options_init(options);
+    options->threads = threads;
+    options->bound = instance->bound;
+}
+
+// All instances submitted at once, two threads each, polled until done.
+static void check_concurrent(MultisetPool* pool, const int expected[])
+{
+    MultisetJob* jobs[INSTANCES_COUNT];
+    for (int i = 0; i < INSTANCES_COUNT; i++) {
+        const Instance* instance = &instances[i];
+        MultisetOptions options;
+        options_for(instance, 2, &options);
+        jobs[i] = multiset_submit(pool, instance->d, instance->a, instance->n, instance->b, instance->m, &options);
+        if (jobs[i] == NULL)
+            fatal("concurrent: %s was rejected", instance->name);
+    }
+    int left = INSTANCES_COUNT;
+    while (left > 0) {
+        for (int i = 0; i < INSTANCES_COUNT; i++) {
+            MultisetSolution solution;
+            if (jobs[i] != NULL && multiset_poll(jobs[i], &solution)) {
+                check_solution("concurrent", &instances[i], &solution, expected[i]);
+                jobs[i] = NULL;
+                left--;
+            }
+        }
+        nanosleep(&(struct timespec) { .tv_sec = 0, .tv_nsec = LIBRARY_POLL_NS }, NULL);
+    }
+}
+
+// One instance after another, with all threads of the pool.
+static void check_back_to_back(MultisetPool* pool, const int expected[])
+{
+    for (int i = 0; i < INSTANCES_COUNT; i++) {
+        const Instance* instance = &instances[i];
+        MultisetOptions options;
+        options_for(instance, 0, &options);
+        MultisetSolution solution;
+        if (!multiset_solve(pool, instance->d, instance->a, instance->n, instance->b, instance->m, &options,
+                &solution))
+            fatal("back to back: %s was rejected", instance->name);
+        check_solution("back to back", instance, &solution, expected[i]);
+    }
+}
+
+static void check_rejected(MultisetPool* pool)
+{
+    static int too_large[MULTISET_MAX_D + 1];
+    for (int i = 0; i <= MULTISET_MAX_D; i++)
+        too_large[i] = MULTISET_MAX_D; // ∑B₀ above MULTISET_MAX_D², too large for any width
+    MultisetOptions options;
+    multiset_options_init(&options);
+    MultisetSolution solution;
+    if (multiset_solve(pool, 2, NULL, 0, NULL, 0, &options, &solution))
+        fatal("rejected: d=2 was solved");
+    if (multiset_solve(pool, 10, (int[]) { 11 }, 1, NULL, 0, &options, &solution))
+        fatal("rejected: an element above d was solved");
+    if (multiset_solve(pool, MULTISET_MAX_D, NULL, 0, too_large, MULTISET_MAX_D + 1, &options, &solution)
+        || multiset_estimate(MULTISET_MAX_D, NULL, 0, too_large, MULTISET_MAX_D + 1, &options, 1) >= 0)
+        fatal("rejected: ∑B₀ = %d was accepted", MULTISET_MAX_D * (MULTISET_MAX_D + 1));
+    options.bound = "no such bound";
+    if (multiset_solve(pool, 10, NULL, 0, NULL, 0, &options, &solution))
+        fatal("rejected: an unknown bound was accepted");
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+        fatal("usage: %s SOLVER", argv[0]);
+    int expected[INSTANCES_COUNT];
+    for (int i = 0; i < INSTANCES_COUNT; i++)
+        expected[i] = solver_sum(argv[1], &instances[i]);
+
+    MultisetPool* pool = multiset_pool_create(LIBRARY_THREADS);
+    check_concurrent(pool, expected);
+    check_back_to_back(pool, expected);
+    check_rejected(pool);
+    multiset_pool_destroy(pool);
+    printf("library: instances=%d threads=%d\n", INSTANCES_COUNT, LIBRARY_THREADS);
+    return 0;
+}